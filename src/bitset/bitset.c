@@ -1,12 +1,321 @@
 #include "bitset.h"
 
+#include <string.h>
+
 #include "../errors/errors.h"
 
+#define HASH_LANES 4
+#define FILTER_PREFETCH_DISTANCE 16
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+typedef enum {
+  UNION_OPERATION,
+  INTERSECTION_OPERATION,
+  DIFFERENCE_OPERATION,
+  SYMMETRIC_DIFFERENCE_OPERATION,
+} BlockOperation;
+
+static size_t getSummarySize(const size_t size) {
+  return (size + BIT_PER_BLOCK - 1) / BIT_PER_BLOCK;
+}
+
+static uint64_t getPositionMask(const size_t position) {
+  return 1ULL << (BIT_PER_BLOCK - position % BIT_PER_BLOCK - 1);
+}
+
+/*
+  Returns the summary word in which all blocks of a set of the given size
+  are marked
+*/
+static uint64_t getBlocksMask(const size_t size, const size_t wordPos) {
+  uint64_t blocksMask = 0;
+  const size_t firstBlock = wordPos * BIT_PER_BLOCK;
+
+  if (firstBlock < size) {
+    const size_t blocksLeft = size - firstBlock;
+    blocksMask = blocksLeft >= BIT_PER_BLOCK
+                     ? ~0ULL
+                     : ~0ULL << (BIT_PER_BLOCK - blocksLeft);
+  }
+
+  return blocksMask;
+}
+
+static size_t getMinSize(const size_t valueA, const size_t valueB) {
+  return valueA < valueB ? valueA : valueB;
+}
+
+static size_t getMaxSize(const size_t valueA, const size_t valueB) {
+  return valueA > valueB ? valueA : valueB;
+}
+
+/*
+  Writes the blocks [firstBlock, endBlock) which may be non-zero. Without
+  the active range these are all blocks of the set. The bounds are only
+  read here, after removals they may be wider than needed. An empty range
+  is written as [0, 0)
+*/
+static void getActiveBlocks(const BitSet *bitSet, size_t *firstBlock,
+                            size_t *endBlock) {
+  const BitSetActiveRange *activeRange = bitSet->activeRange;
+  *firstBlock = 0;
+  *endBlock = bitSet->size;
+
+  if (activeRange != NULL) {
+    *firstBlock = __atomic_load_n(&activeRange->firstBlock, __ATOMIC_RELAXED);
+    const size_t lastBlock =
+        __atomic_load_n(&activeRange->lastBlock, __ATOMIC_RELAXED);
+    if (*firstBlock <= lastBlock) {
+      *endBlock = lastBlock + 1;
+    } else {
+      *firstBlock = 0;
+      *endBlock = 0;
+    }
+  }
+}
+
+/*
+  Writes the smallest block range which covers both ranges.
+  An empty range adds nothing to the other one
+*/
+static void coverActiveBlocks(const size_t firstInA, const size_t endInA,
+                              const size_t firstInB, const size_t endInB,
+                              size_t *firstBlock, size_t *endBlock) {
+  if (firstInA >= endInA) {
+    *firstBlock = firstInB;
+    *endBlock = endInB;
+  } else if (firstInB >= endInB) {
+    *firstBlock = firstInA;
+    *endBlock = endInA;
+  } else {
+    *firstBlock = getMinSize(firstInA, firstInB);
+    *endBlock = getMaxSize(endInA, endInB);
+  }
+}
+
+/*
+  Writes the summary words [firstWord, endWord) which cover the active blocks
+*/
+static void getActiveWords(const BitSet *bitSet, size_t *firstWord,
+                           size_t *endWord) {
+  size_t firstBlock = 0;
+  size_t endBlock = 0;
+  getActiveBlocks(bitSet, &firstBlock, &endBlock);
+
+  *firstWord = firstBlock / BIT_PER_BLOCK;
+  *endWord = firstBlock < endBlock ? getSummarySize(endBlock) : *firstWord;
+}
+
+/*
+  Widens the active range so that it includes the block. Bulk construction
+  and allocation extend the range from several threads, so the bounds are
+  updated atomically
+*/
+static void extendActiveRange(const BitSet *bitSet, const size_t blockPos) {
+  BitSetActiveRange *activeRange = bitSet->activeRange;
+
+  if (activeRange != NULL) {
+    size_t firstBlock =
+        __atomic_load_n(&activeRange->firstBlock, __ATOMIC_RELAXED);
+    while (blockPos < firstBlock &&
+           !__atomic_compare_exchange_n(&activeRange->firstBlock, &firstBlock,
+                                        blockPos, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+    }
+
+    size_t lastBlock = __atomic_load_n(&activeRange->lastBlock, __ATOMIC_RELAXED);
+    while (blockPos > lastBlock &&
+           !__atomic_compare_exchange_n(&activeRange->lastBlock, &lastBlock,
+                                        blockPos, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+    }
+  }
+}
+
+/*
+  Notes that the block has become zero. If it lies on a bound, the bound
+  is moved the next time the exact range is needed
+*/
+static void shrinkActiveRange(const BitSet *bitSet, const size_t blockPos) {
+  BitSetActiveRange *activeRange = bitSet->activeRange;
+
+  if (activeRange != NULL &&
+      (blockPos == __atomic_load_n(&activeRange->firstBlock, __ATOMIC_RELAXED) ||
+       blockPos == __atomic_load_n(&activeRange->lastBlock, __ATOMIC_RELAXED))) {
+    __atomic_store_n(&activeRange->isStale, true, __ATOMIC_RELAXED);
+  }
+}
+
+static bool isBlockEmpty(const BitSet *bitSet, const size_t blockPos) {
+  return __atomic_load_n(&bitSet->bits[blockPos], __ATOMIC_RELAXED) == 0;
+}
+
+/*
+  Moves the bounds of a stale active range inwards to the first and last
+  non-zero blocks. An empty range ends up with firstBlock = lastBlock + 1.
+  Finds call this while allocators may extend the range, so the bounds
+  are only moved with CAS, and a bound moved by an allocator is kept
+*/
+static void tightenActiveRange(const BitSet *bitSet) {
+  BitSetActiveRange *activeRange = bitSet->activeRange;
+
+  if (activeRange != NULL &&
+      __atomic_load_n(&activeRange->isStale, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&activeRange->isStale, false, __ATOMIC_RELAXED);
+
+    size_t firstBlock =
+        __atomic_load_n(&activeRange->firstBlock, __ATOMIC_RELAXED);
+    size_t lastBlock = __atomic_load_n(&activeRange->lastBlock, __ATOMIC_RELAXED);
+    const size_t oldFirstBlock = firstBlock;
+    const size_t oldLastBlock = lastBlock;
+
+    size_t newFirstBlock = firstBlock;
+    while (newFirstBlock <= lastBlock && isBlockEmpty(bitSet, newFirstBlock)) {
+      newFirstBlock++;
+    }
+    size_t newLastBlock = lastBlock;
+    while (newLastBlock > newFirstBlock && isBlockEmpty(bitSet, newLastBlock)) {
+      newLastBlock--;
+    }
+
+    // Moving only the first bound past the last one keeps any later
+    // extension by an allocator consistent
+    __atomic_compare_exchange_n(&activeRange->firstBlock, &firstBlock,
+                                newFirstBlock, false, __ATOMIC_RELAXED,
+                                __ATOMIC_RELAXED);
+    if (newFirstBlock <= oldLastBlock) {
+      __atomic_compare_exchange_n(&activeRange->lastBlock, &lastBlock,
+                                  newLastBlock, false, __ATOMIC_RELAXED,
+                                  __ATOMIC_RELAXED);
+    }
+
+    // Pairs with the fence of markBlockInSummary. An allocator which filled
+    // a skipped block but still saw the old bounds is caught here
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (size_t blockPos = oldFirstBlock;
+         blockPos < newFirstBlock && blockPos <= oldLastBlock; blockPos++) {
+      if (!isBlockEmpty(bitSet, blockPos)) {
+        extendActiveRange(bitSet, blockPos);
+      }
+    }
+    for (size_t blockPos = newLastBlock + 1;
+         newFirstBlock <= oldLastBlock && blockPos <= oldLastBlock;
+         blockPos++) {
+      if (!isBlockEmpty(bitSet, blockPos)) {
+        extendActiveRange(bitSet, blockPos);
+      }
+    }
+  }
+}
+
+/*
+  Recomputes the existing active range from the blocks
+*/
+static void refreshBitSetActiveRange(const BitSet *bitSet) {
+  bitSet->activeRange->firstBlock = 0;
+  bitSet->activeRange->lastBlock = bitSet->size - 1;
+  bitSet->activeRange->isStale = true;
+  tightenActiveRange(bitSet);
+}
+
+/*
+  Allocates the active range of an empty set
+*/
+static BaseErrorCode createActiveRange(BitSet *bitSet) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  disableBitSetActiveRange(bitSet);
+  bitSet->activeRange = malloc(sizeof(BitSetActiveRange));
+
+  if (bitSet->activeRange == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  } else {
+    bitSet->activeRange->firstBlock = bitSet->size;
+    bitSet->activeRange->lastBlock = 0;
+    bitSet->activeRange->isStale = false;
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode enableBitSetActiveRange(BitSet *bitSet) {
+  const BaseErrorCode statusCode = createActiveRange(bitSet);
+
+  if (statusCode == NONE_ERROR) {
+    refreshBitSetActiveRange(bitSet);
+  }
+
+  return statusCode;
+}
+
+void disableBitSetActiveRange(BitSet *bitSet) {
+  free(bitSet->activeRange);
+  bitSet->activeRange = NULL;
+}
+
+size_t getBitSetSummarySize(const BitSet *bitSet) {
+  return getSummarySize(bitSet->size);
+}
+
+uint64_t getBitSetSummaryWord(const BitSet *bitSet, const size_t wordPos) {
+  size_t firstBlock = 0;
+  size_t endBlock = 0;
+  getActiveBlocks(bitSet, &firstBlock, &endBlock);
+
+  uint64_t summaryWord = getBlocksMask(endBlock, wordPos) &
+                         ~getBlocksMask(firstBlock, wordPos);
+
+  if (bitSet->summary != NULL && summaryWord != 0) {
+    summaryWord &= bitSet->summary[wordPos];
+  }
+
+  return summaryWord;
+}
+
+/*
+  Returns the mask of the block bits which belong to [0, capacity]
+*/
+static uint64_t getValidBitsMask(const BitSet *bitSet, const size_t blockPos) {
+  uint64_t validMask = ~0ULL;
+
+  if (blockPos + 1 == bitSet->size) {
+    const size_t usedBits = bitSet->capacity % BIT_PER_BLOCK + 1;
+    if (usedBits < BIT_PER_BLOCK) {
+      validMask = ~0ULL << (BIT_PER_BLOCK - usedBits);
+    }
+  }
+
+  return validMask;
+}
+
+/*
+  Returns the mask of the block bits for the elements in [from, to)
+*/
+static uint64_t getRangeMask(const size_t blockPos, const uint64_t from,
+                             const uint64_t to) {
+  const uint64_t blockStart = (uint64_t)blockPos * BIT_PER_BLOCK;
+  const uint64_t begin = from > blockStart ? from - blockStart : 0;
+  const uint64_t end = to - blockStart < BIT_PER_BLOCK ? to - blockStart
+                                                       : BIT_PER_BLOCK;
+
+  uint64_t rangeMask = 0;
+  if (begin < end) {
+    rangeMask = ~0ULL >> begin;
+    if (end < BIT_PER_BLOCK) {
+      rangeMask &= ~(~0ULL >> end);
+    }
+  }
+
+  return rangeMask;
+}
+
 BitSet createBitSet(const size_t capacity) {
   BitSet bitSet;
 
   bitSet.capacity = capacity;
-  bitSet.size = (capacity + 63) / 64;
+  bitSet.size = capacity / BIT_PER_BLOCK + 1;
+  bitSet.summary = NULL;
+  bitSet.activeRange = NULL;
 
   bitSet.bits = (uint64_t *)calloc(bitSet.size, sizeof(uint64_t));
 
@@ -19,11 +328,118 @@ BitSet createBitSet(const size_t capacity) {
   return bitSet;
 }
 
+BitSet createAlignedBitSet(const size_t capacity, const size_t alignment) {
+  BitSet bitSet;
+
+  bitSet.capacity = capacity;
+  bitSet.size = capacity / BIT_PER_BLOCK + 1;
+  bitSet.summary = NULL;
+  bitSet.activeRange = NULL;
+
+  // aligned_alloc needs the size to be a multiple of the alignment
+  const size_t blockBytes = bitSet.size * sizeof(uint64_t);
+  const size_t allocatedBytes =
+      (blockBytes + alignment - 1) / alignment * alignment;
+  bitSet.bits = (uint64_t *)aligned_alloc(alignment, allocatedBytes);
+
+  if (bitSet.bits == NULL) {
+    bitSet.capacity = 0;
+  } else {
+    memset(bitSet.bits, 0, allocatedBytes);
+  }
+
+  return bitSet;
+}
+
+BitSet copyBitSet(const BitSet *bitSet) {
+  BitSet resultBitSet = createBitSet(bitSet->capacity);
+
+  if (resultBitSet.bits != NULL) {
+    memcpy(resultBitSet.bits, bitSet->bits,
+           resultBitSet.size * sizeof(uint64_t));
+
+    if (bitSet->summary != NULL) {
+      enableBitSetSummary(&resultBitSet);
+    }
+    if (bitSet->activeRange != NULL) {
+      enableBitSetActiveRange(&resultBitSet);
+    }
+  }
+
+  return resultBitSet;
+}
+
 void destroyBitSet(BitSet *bitSet) {
   bitSet->size = 0;
   bitSet->capacity = 0;
   free(bitSet->bits);
   bitSet->bits = NULL;
+  disableBitSetSummary(bitSet);
+  disableBitSetActiveRange(bitSet);
+}
+
+/*
+  Recomputes the existing summary from the blocks
+*/
+static void refreshBitSetSummary(const BitSet *bitSet) {
+  memset(bitSet->summary, 0, getSummarySize(bitSet->size) * sizeof(uint64_t));
+
+  for (size_t blockPos = 0; blockPos < bitSet->size; blockPos++) {
+    if (bitSet->bits[blockPos] != 0) {
+      bitSet->summary[blockPos / BIT_PER_BLOCK] |= getPositionMask(blockPos);
+    }
+  }
+}
+
+/*
+  Allocates a zero summary, which matches only an empty set
+*/
+static BaseErrorCode createSummary(BitSet *bitSet) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  disableBitSetSummary(bitSet);
+  bitSet->summary =
+      (uint64_t *)calloc(getSummarySize(bitSet->size), sizeof(uint64_t));
+
+  if (bitSet->summary == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode enableBitSetSummary(BitSet *bitSet) {
+  const BaseErrorCode statusCode = createSummary(bitSet);
+
+  if (statusCode == NONE_ERROR) {
+    refreshBitSetSummary(bitSet);
+  }
+
+  return statusCode;
+}
+
+void disableBitSetSummary(BitSet *bitSet) {
+  free(bitSet->summary);
+  bitSet->summary = NULL;
+}
+
+void setBitSetBlock(const BitSet *bitSet, const size_t blockPos,
+                    const uint64_t block) {
+  bitSet->bits[blockPos] = block & getValidBitsMask(bitSet, blockPos);
+
+  if (bitSet->summary != NULL) {
+    if (bitSet->bits[blockPos] != 0) {
+      bitSet->summary[blockPos / BIT_PER_BLOCK] |= getPositionMask(blockPos);
+    } else {
+      bitSet->summary[blockPos / BIT_PER_BLOCK] &= ~getPositionMask(blockPos);
+    }
+  }
+
+  if (bitSet->bits[blockPos] != 0) {
+    extendActiveRange(bitSet, blockPos);
+  } else {
+    shrinkActiveRange(bitSet, blockPos);
+  }
 }
 
 BaseErrorCode checkElementValidity(const BitSet *bitSet, const uint64_t element) {
@@ -44,6 +460,12 @@ BaseErrorCode addBitSetElement(const BitSet *bitSet, const uint64_t element) {
     const uint64_t blockPosition = element / BIT_PER_BLOCK;
     const uint64_t bitOffset = BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1;
     bitSet->bits[blockPosition] |= 1ULL << bitOffset;
+
+    if (bitSet->summary != NULL) {
+      bitSet->summary[blockPosition / BIT_PER_BLOCK] |=
+          getPositionMask(blockPosition);
+    }
+    extendActiveRange(bitSet, blockPosition);
   }
 
   return statusCode;
@@ -60,6 +482,88 @@ BaseErrorCode addManyBitSetElements(const BitSet *bitSet, const size_t count,
   return statusCode;
 }
 
+BaseErrorCode mergeBitSets(const BitSet *target, const BitSet *source) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  size_t firstWord = 0;
+  size_t endWord = 0;
+  getActiveWords(source, &firstWord, &endWord);
+
+  for (size_t wordPos = firstWord; wordPos < endWord; wordPos++) {
+    uint64_t candidates = getBitSetSummaryWord(source, wordPos);
+
+    while (candidates != 0) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      const size_t blockPos = wordPos * BIT_PER_BLOCK + leadingZeros;
+      candidates &= ~getPositionMask(leadingZeros);
+
+      uint64_t block = source->bits[blockPos];
+      if (block != 0 && blockPos < target->size) {
+        const uint64_t validMask = getValidBitsMask(target, blockPos);
+        if ((block & ~validMask) != 0) {
+          statusCode = CAPACITY_EXCEEDING_ERROR;
+        }
+        block &= validMask;
+      } else if (block != 0) {
+        statusCode = CAPACITY_EXCEEDING_ERROR;
+        block = 0;
+      }
+
+      if (block != 0) {
+        target->bits[blockPos] |= block;
+        if (target->summary != NULL) {
+          target->summary[wordPos] |= getPositionMask(leadingZeros);
+        }
+        extendActiveRange(target, blockPos);
+      }
+    }
+  }
+
+  return statusCode;
+}
+
+static BaseErrorCode checkRangeValidity(const BitSet *bitSet,
+                                        const uint64_t from,
+                                        const uint64_t to) {
+  BaseErrorCode validityStatus = NONE_ERROR;
+  if (from > to) {
+    validityStatus = INVALID_ARGUMENT_ERROR;
+  } else if (to > (uint64_t)bitSet->capacity + 1) {
+    validityStatus = CAPACITY_EXCEEDING_ERROR;
+  }
+
+  return validityStatus;
+}
+
+BaseErrorCode addBitSetRange(const BitSet *bitSet, const uint64_t from,
+                             const uint64_t to) {
+  const BaseErrorCode statusCode = checkRangeValidity(bitSet, from, to);
+
+  if (statusCode == NONE_ERROR && from < to) {
+    for (size_t blockPos = from / BIT_PER_BLOCK;
+         blockPos <= (to - 1) / BIT_PER_BLOCK; blockPos++) {
+      setBitSetBlock(bitSet, blockPos,
+                     bitSet->bits[blockPos] | getRangeMask(blockPos, from, to));
+    }
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode removeBitSetRange(const BitSet *bitSet, const uint64_t from,
+                                const uint64_t to) {
+  const BaseErrorCode statusCode = checkRangeValidity(bitSet, from, to);
+
+  if (statusCode == NONE_ERROR && from < to) {
+    for (size_t blockPos = from / BIT_PER_BLOCK;
+         blockPos <= (to - 1) / BIT_PER_BLOCK; blockPos++) {
+      setBitSetBlock(bitSet, blockPos,
+                     bitSet->bits[blockPos] & ~getRangeMask(blockPos, from, to));
+    }
+  }
+
+  return statusCode;
+}
+
 BaseErrorCode removeBitSetElement(const BitSet *bitSet, const uint64_t element) {
   BaseErrorCode statusCode = NONE_ERROR;
 
@@ -69,6 +573,14 @@ BaseErrorCode removeBitSetElement(const BitSet *bitSet, const uint64_t element)
     const uint64_t blockPosition = element / BIT_PER_BLOCK;
     const uint64_t bitOffset = BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1;
     bitSet->bits[blockPosition] &= ~(1ULL << bitOffset);
+
+    if (bitSet->bits[blockPosition] == 0) {
+      if (bitSet->summary != NULL) {
+        bitSet->summary[blockPosition / BIT_PER_BLOCK] &=
+            ~getPositionMask(blockPosition);
+      }
+      shrinkActiveRange(bitSet, blockPosition);
+    }
   }
 
   return statusCode;
@@ -87,23 +599,500 @@ bool isBitSetContains(const BitSet *bitSet, const uint64_t element) {
   return isContains;
 }
 
+size_t filterBitSetElements(const BitSet *bitSet, const size_t count,
+                            uint64_t elements[]) {
+  size_t kept = 0;
+
+  for (size_t iter = 0; iter < count; iter++) {
+    if (iter + FILTER_PREFETCH_DISTANCE < count) {
+      const uint64_t ahead = elements[iter + FILTER_PREFETCH_DISTANCE];
+      if (ahead <= (uint64_t)bitSet->capacity) {
+        __builtin_prefetch(&bitSet->bits[ahead / BIT_PER_BLOCK]);
+      }
+    }
+
+    // Invalid numbers read block 0 and are masked out, so there is no branch
+    const uint64_t element = elements[iter];
+    const uint64_t isValid = element <= (uint64_t)bitSet->capacity;
+    const size_t blockPos = (size_t)(element / BIT_PER_BLOCK * isValid);
+    const uint64_t isMember =
+        bitSet->bits[blockPos] >> (BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1) &
+        isValid;
+
+    elements[kept] = element;
+    kept += (size_t)isMember;
+  }
+
+  return kept;
+}
+
+static bool isElementsSorted(const size_t count, const uint64_t elements[]) {
+  bool isSorted = true;
+
+  for (size_t iter = 1; iter < count && isSorted; iter++) {
+    isSorted = elements[iter - 1] <= elements[iter];
+  }
+
+  return isSorted;
+}
+
+/*
+  Collects the numbers of the ascending array up to maxElement which fall
+  into the block of elements[*position] into one mask and moves the
+  position past them
+*/
+static uint64_t collectBlockMask(const size_t count, const uint64_t elements[],
+                                 const uint64_t maxElement, size_t *position) {
+  const uint64_t blockPos = elements[*position] / BIT_PER_BLOCK;
+  uint64_t mask = 0;
+
+  while (*position < count && elements[*position] <= maxElement &&
+         elements[*position] / BIT_PER_BLOCK == blockPos) {
+    mask |= getPositionMask(elements[*position]);
+    (*position)++;
+  }
+
+  return mask;
+}
+
+BaseErrorCode intersectBitSetWithSortedElements(const BitSet *bitSet,
+                                                const size_t count,
+                                                const uint64_t elements[]) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  uint64_t first = 0;
+  uint64_t last = 0;
+
+  if (!isElementsSorted(count, elements)) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else if (findFirstBitSetElement(bitSet, &first) == NONE_ERROR) {
+    findLastBitSetElement(bitSet, &last);
+
+    // Only the blocks between the first and the last element can be cleared
+    const uint64_t end = last + 1;
+    uint64_t clearedUpTo = first;
+    size_t position = 0;
+
+    while (position < count && elements[position] < end) {
+      const size_t blockPos = elements[position] / BIT_PER_BLOCK;
+      const uint64_t blockStart = (uint64_t)blockPos * BIT_PER_BLOCK;
+      const uint64_t mask = collectBlockMask(count, elements, last, &position);
+
+      if (blockStart > clearedUpTo) {
+        removeBitSetRange(bitSet, clearedUpTo, blockStart);
+      }
+      if (blockStart + BIT_PER_BLOCK > clearedUpTo) {
+        setBitSetBlock(bitSet, blockPos, bitSet->bits[blockPos] & mask);
+        clearedUpTo = blockStart + BIT_PER_BLOCK;
+      }
+    }
+
+    if (clearedUpTo < end) {
+      removeBitSetRange(bitSet, clearedUpTo, end);
+    }
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode mergeSortedElementsIntoBitSet(const BitSet *bitSet,
+                                            const size_t count,
+                                            const uint64_t elements[]) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  size_t position = 0;
+
+  if (!isElementsSorted(count, elements)) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    while (position < count &&
+           elements[position] <= (uint64_t)bitSet->capacity) {
+      const size_t blockPos = elements[position] / BIT_PER_BLOCK;
+      const uint64_t mask = collectBlockMask(
+          count, elements, (uint64_t)bitSet->capacity, &position);
+
+      setBitSetBlock(bitSet, blockPos, bitSet->bits[blockPos] | mask);
+    }
+
+    // In ascending order everything after the first invalid number is invalid
+    if (position < count) {
+      statusCode = CAPACITY_EXCEEDING_ERROR;
+    }
+  }
+
+  return statusCode;
+}
+
+size_t getBitSetCount(const BitSet *bitSet) {
+  size_t count = 0;
+  size_t firstWord = 0;
+  size_t endWord = 0;
+  getActiveWords(bitSet, &firstWord, &endWord);
+
+  for (size_t wordPos = firstWord; wordPos < endWord; wordPos++) {
+    uint64_t candidates = getBitSetSummaryWord(bitSet, wordPos);
+
+    while (candidates != 0) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      const size_t blockPos = wordPos * BIT_PER_BLOCK + leadingZeros;
+      candidates &= ~getPositionMask(leadingZeros);
+
+      count += (size_t)__builtin_popcountll(bitSet->bits[blockPos]);
+    }
+  }
+
+  return count;
+}
+
+bool isBitSetEmpty(const BitSet *bitSet) {
+  bool isEmpty = true;
+  size_t firstWord = 0;
+  size_t endWord = 0;
+  getActiveWords(bitSet, &firstWord, &endWord);
+
+  for (size_t wordPos = firstWord; wordPos < endWord && isEmpty; wordPos++) {
+    uint64_t candidates = getBitSetSummaryWord(bitSet, wordPos);
+
+    while (candidates != 0 && isEmpty) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      const size_t blockPos = wordPos * BIT_PER_BLOCK + leadingZeros;
+      candidates &= ~getPositionMask(leadingZeros);
+
+      if (bitSet->bits[blockPos] != 0) {
+        isEmpty = false;
+      }
+    }
+  }
+
+  return isEmpty;
+}
+
+BaseErrorCode findFirstBitSetElement(const BitSet *bitSet, uint64_t *element) {
+  BaseErrorCode statusCode = ELEMENT_NOT_FOUND_ERROR;
+  size_t firstWord = 0;
+  size_t endWord = 0;
+
+  // With exact bounds the first candidate block is the answer
+  tightenActiveRange(bitSet);
+  getActiveWords(bitSet, &firstWord, &endWord);
+
+  for (size_t wordPos = firstWord; wordPos < endWord && statusCode; wordPos++) {
+    uint64_t candidates = getBitSetSummaryWord(bitSet, wordPos);
+
+    while (candidates != 0 && statusCode) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      const size_t blockPos = wordPos * BIT_PER_BLOCK + leadingZeros;
+      candidates &= ~getPositionMask(leadingZeros);
+
+      const uint64_t block = bitSet->bits[blockPos];
+      if (block != 0) {
+        *element = (uint64_t)blockPos * BIT_PER_BLOCK + __builtin_clzll(block);
+        statusCode = NONE_ERROR;
+      }
+    }
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode findLastBitSetElement(const BitSet *bitSet, uint64_t *element) {
+  BaseErrorCode statusCode = ELEMENT_NOT_FOUND_ERROR;
+  size_t firstWord = 0;
+  size_t endWord = 0;
+
+  tightenActiveRange(bitSet);
+  getActiveWords(bitSet, &firstWord, &endWord);
+
+  for (size_t wordPos = endWord; wordPos > firstWord && statusCode; wordPos--) {
+    uint64_t candidates = getBitSetSummaryWord(bitSet, wordPos - 1);
+
+    while (candidates != 0 && statusCode) {
+      // Later blocks lie towards the least significant bits
+      const int trailingZeros = __builtin_ctzll(candidates);
+      const size_t blockPos = wordPos * BIT_PER_BLOCK - trailingZeros - 1;
+      candidates &= candidates - 1;
+
+      const uint64_t block = bitSet->bits[blockPos];
+      if (block != 0) {
+        *element = (uint64_t)blockPos * BIT_PER_BLOCK + BIT_PER_BLOCK -
+                   __builtin_ctzll(block) - 1;
+        statusCode = NONE_ERROR;
+      }
+    }
+  }
+
+  return statusCode;
+}
+
+/*
+  Searches for a number not in the set among [from, to)
+*/
+static BaseErrorCode findFreeElementInRange(const BitSet *bitSet,
+                                            const uint64_t from,
+                                            const uint64_t to,
+                                            uint64_t *element) {
+  BaseErrorCode statusCode = ELEMENT_NOT_FOUND_ERROR;
+  const size_t lastBlock = to == 0 ? 0 : (to - 1) / BIT_PER_BLOCK;
+
+  for (size_t blockPos = from / BIT_PER_BLOCK;
+       from < to && blockPos <= lastBlock && statusCode; blockPos++) {
+    const uint64_t block = __atomic_load_n(&bitSet->bits[blockPos],
+                                           __ATOMIC_RELAXED);
+    const uint64_t freeBits = ~block & getValidBitsMask(bitSet, blockPos) &
+                              getRangeMask(blockPos, from, to);
+
+    if (freeBits != 0) {
+      *element = (uint64_t)blockPos * BIT_PER_BLOCK + __builtin_clzll(freeBits);
+      statusCode = NONE_ERROR;
+    }
+  }
+
+  return statusCode;
+}
+
+/*
+  Returns the first number from start which is in the set or lies
+  beyond the capacity
+*/
+static uint64_t findOccupiedElement(const BitSet *bitSet, const uint64_t start) {
+  const uint64_t totalBits = (uint64_t)bitSet->size * BIT_PER_BLOCK;
+  uint64_t occupied = totalBits;
+
+  for (size_t blockPos = start / BIT_PER_BLOCK;
+       blockPos < bitSet->size && occupied == totalBits; blockPos++) {
+    const uint64_t block = __atomic_load_n(&bitSet->bits[blockPos],
+                                           __ATOMIC_RELAXED);
+    const uint64_t occupiedBits = (block | ~getValidBitsMask(bitSet, blockPos)) &
+                                  getRangeMask(blockPos, start, totalBits);
+
+    if (occupiedBits != 0) {
+      occupied = (uint64_t)blockPos * BIT_PER_BLOCK + __builtin_clzll(occupiedBits);
+    }
+  }
+
+  return occupied;
+}
+
+BaseErrorCode findFirstBitSetFreeElement(const BitSet *bitSet,
+                                         uint64_t *element) {
+  return findFreeElementInRange(bitSet, 0, (uint64_t)bitSet->capacity + 1,
+                                element);
+}
+
+BaseErrorCode findNextBitSetFreeElement(const BitSet *bitSet,
+                                        const uint64_t hint,
+                                        uint64_t *element) {
+  const uint64_t end = (uint64_t)bitSet->capacity + 1;
+  const uint64_t start = hint < end ? hint : 0;
+
+  BaseErrorCode statusCode = findFreeElementInRange(bitSet, start, end, element);
+  if (statusCode) {
+    statusCode = findFreeElementInRange(bitSet, 0, start, element);
+  }
+
+  return statusCode;
+}
+
+static void markBlockInSummary(const BitSet *bitSet, const size_t blockPos) {
+  if (bitSet->summary != NULL) {
+    __atomic_fetch_or(&bitSet->summary[blockPos / BIT_PER_BLOCK],
+                      getPositionMask(blockPos), __ATOMIC_RELAXED);
+  }
+
+  // The block is filled before the bounds are read, see tightenActiveRange
+  if (bitSet->activeRange != NULL) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  }
+  extendActiveRange(bitSet, blockPos);
+}
+
+/*
+  Atomically adds the first free number of [from, to) and writes it
+*/
+static BaseErrorCode allocateElementInRange(const BitSet *bitSet,
+                                            const uint64_t from,
+                                            const uint64_t to,
+                                            uint64_t *element) {
+  BaseErrorCode statusCode = ELEMENT_NOT_FOUND_ERROR;
+  const size_t lastBlock = to == 0 ? 0 : (to - 1) / BIT_PER_BLOCK;
+
+  for (size_t blockPos = from / BIT_PER_BLOCK;
+       from < to && blockPos <= lastBlock && statusCode; blockPos++) {
+    const uint64_t validMask =
+        getValidBitsMask(bitSet, blockPos) & getRangeMask(blockPos, from, to);
+    uint64_t block = __atomic_load_n(&bitSet->bits[blockPos], __ATOMIC_RELAXED);
+    uint64_t freeBits = ~block & validMask;
+
+    while (freeBits != 0 && statusCode) {
+      const int leadingZeros = __builtin_clzll(freeBits);
+      const uint64_t mask = getPositionMask(leadingZeros);
+
+      // On failure the CAS reloads the block, so the free bits are refreshed
+      if (__atomic_compare_exchange_n(&bitSet->bits[blockPos], &block,
+                                      block | mask, false, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_RELAXED)) {
+        markBlockInSummary(bitSet, blockPos);
+        *element = (uint64_t)blockPos * BIT_PER_BLOCK + leadingZeros;
+        statusCode = NONE_ERROR;
+      } else {
+        freeBits = ~block & validMask;
+      }
+    }
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode allocateBitSetElement(const BitSet *bitSet, uint64_t *element) {
+  return allocateElementInRange(bitSet, 0, (uint64_t)bitSet->capacity + 1,
+                                element);
+}
+
+BaseErrorCode allocateNextBitSetElement(const BitSet *bitSet,
+                                        const uint64_t hint,
+                                        uint64_t *element) {
+  const uint64_t end = (uint64_t)bitSet->capacity + 1;
+  const uint64_t start = hint < end ? hint : 0;
+
+  BaseErrorCode statusCode =
+      allocateElementInRange(bitSet, start, end, element);
+  if (statusCode) {
+    statusCode = allocateElementInRange(bitSet, 0, start, element);
+  }
+
+  return statusCode;
+}
+
+/*
+  Sets the bits of [from, to) block by block if all of them are free.
+  If another thread takes one of them first, the claimed blocks are
+  released and false returns
+*/
+static bool claimBitSetRange(const BitSet *bitSet, const uint64_t from,
+                             const uint64_t to) {
+  bool isClaimed = true;
+  const size_t firstBlock = from / BIT_PER_BLOCK;
+  const size_t lastBlock = (to - 1) / BIT_PER_BLOCK;
+  size_t blockPos = firstBlock;
+
+  for (; blockPos <= lastBlock && isClaimed; blockPos++) {
+    const uint64_t mask = getRangeMask(blockPos, from, to);
+    uint64_t block = __atomic_load_n(&bitSet->bits[blockPos], __ATOMIC_RELAXED);
+
+    bool isBlockClaimed = false;
+    while (!isBlockClaimed && isClaimed) {
+      if ((block & mask) != 0) {
+        isClaimed = false;
+      } else {
+        isBlockClaimed = __atomic_compare_exchange_n(
+            &bitSet->bits[blockPos], &block, block | mask, false,
+            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+      }
+    }
+  }
+
+  if (!isClaimed) {
+    // The last visited block was not claimed, only the ones before it
+    for (size_t releasePos = firstBlock; releasePos + 1 < blockPos; releasePos++) {
+      __atomic_fetch_and(&bitSet->bits[releasePos],
+                         ~getRangeMask(releasePos, from, to), __ATOMIC_RELEASE);
+    }
+  } else {
+    for (size_t markPos = firstBlock; markPos <= lastBlock; markPos++) {
+      markBlockInSummary(bitSet, markPos);
+    }
+  }
+
+  return isClaimed;
+}
+
+BaseErrorCode allocateBitSetRange(const BitSet *bitSet, const size_t count,
+                                  uint64_t *first) {
+  BaseErrorCode statusCode = ELEMENT_NOT_FOUND_ERROR;
+  const uint64_t end = (uint64_t)bitSet->capacity + 1;
+  uint64_t position = 0;
+
+  if (count == 0) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  }
+
+  while (statusCode == ELEMENT_NOT_FOUND_ERROR && position < end &&
+         findFreeElementInRange(bitSet, position, end, &position) == NONE_ERROR) {
+    const uint64_t occupied = findOccupiedElement(bitSet, position);
+
+    if (occupied - position < count) {
+      position = occupied;
+    } else if (claimBitSetRange(bitSet, position, position + count)) {
+      *first = position;
+      statusCode = NONE_ERROR;
+    }
+  }
+
+  return statusCode;
+}
+
 bool isBitSetsEqual(const BitSet *bitSet1, const BitSet *bitSet2) {
   bool isEquals = true;
   if (bitSet1->capacity != bitSet2->capacity ||
       bitSet1->size != bitSet2->size) {
       isEquals = false;
-  } else {
-    const size_t setLength = bitSet1->size;
-    for (size_t blockPos = 0; blockPos < setLength; blockPos++) {
-      if (bitSet1->bits[blockPos] != bitSet2->bits[blockPos]) {
-        isEquals = false;
-      }
-    }
+  } else if (bitSet1->bits != bitSet2->bits) {
+    size_t firstIn1 = 0;
+    size_t endIn1 = 0;
+    size_t firstIn2 = 0;
+    size_t endIn2 = 0;
+    getActiveBlocks(bitSet1, &firstIn1, &endIn1);
+    getActiveBlocks(bitSet2, &firstIn2, &endIn2);
+
+    // Outside both active ranges all blocks are zero.
+    // memcmp stops at the first differing block
+    size_t firstBlock = 0;
+    size_t endBlock = 0;
+    coverActiveBlocks(firstIn1, endIn1, firstIn2, endIn2, &firstBlock,
+                      &endBlock);
+    isEquals = firstBlock >= endBlock ||
+               memcmp(bitSet1->bits + firstBlock, bitSet2->bits + firstBlock,
+                      (endBlock - firstBlock) * sizeof(uint64_t)) == 0;
   }
 
   return isEquals;
 }
 
+static uint64_t mixHash(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDULL;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ULL;
+  hash ^= hash >> 33;
+
+  return hash;
+}
+
+uint64_t getBitSetHash(const BitSet *bitSet) {
+  // Independent lanes let the compiler keep several blocks in flight
+  uint64_t lanes[HASH_LANES] = {HASH_MULTIPLIER, ~HASH_MULTIPLIER,
+                                HASH_MULTIPLIER << 1, HASH_MULTIPLIER >> 1};
+  const size_t fullSize = bitSet->size - bitSet->size % HASH_LANES;
+
+  for (size_t blockPos = 0; blockPos < fullSize; blockPos += HASH_LANES) {
+    for (size_t lane = 0; lane < HASH_LANES; lane++) {
+      lanes[lane] = (lanes[lane] ^ bitSet->bits[blockPos + lane]) *
+                    HASH_MULTIPLIER;
+      lanes[lane] ^= lanes[lane] >> 29;
+    }
+  }
+
+  for (size_t blockPos = fullSize; blockPos < bitSet->size; blockPos++) {
+    lanes[blockPos - fullSize] =
+        (lanes[blockPos - fullSize] ^ bitSet->bits[blockPos]) * HASH_MULTIPLIER;
+  }
+
+  uint64_t hash = (uint64_t)bitSet->capacity;
+  for (size_t lane = 0; lane < HASH_LANES; lane++) {
+    hash = (hash ^ mixHash(lanes[lane])) * HASH_MULTIPLIER;
+  }
+
+  return mixHash(hash);
+}
+
 bool isSubset(const BitSet *bitSetA, const BitSet *bitSetB) {
   bool isSubSet = true;
 
@@ -111,14 +1100,21 @@ bool isSubset(const BitSet *bitSetA, const BitSet *bitSetB) {
     isSubSet = false;
   }
 
-  for (size_t iter = 0; iter < bitSetA->capacity && isSubSet; iter++) {
-    const size_t blockPos = iter / BIT_PER_BLOCK;
-    const size_t bitOffset = BIT_PER_BLOCK - iter % BIT_PER_BLOCK - 1;
-    const bool numberInA = bitSetA->bits[blockPos] >> bitOffset & 1;
-    const bool numberInB = bitSetB->bits[blockPos] >> bitOffset & 1;
+  size_t firstWord = 0;
+  size_t endWord = 0;
+  getActiveWords(bitSetA, &firstWord, &endWord);
+
+  for (size_t wordPos = firstWord; wordPos < endWord && isSubSet; wordPos++) {
+    uint64_t candidates = getBitSetSummaryWord(bitSetA, wordPos);
 
-    if (numberInA && !numberInB) {
-      isSubSet = false;
+    while (candidates != 0 && isSubSet) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      const size_t blockPos = wordPos * BIT_PER_BLOCK + leadingZeros;
+      candidates &= ~getPositionMask(leadingZeros);
+
+      if ((bitSetA->bits[blockPos] & ~bitSetB->bits[blockPos]) != 0) {
+        isSubSet = false;
+      }
     }
   }
   return isSubSet;
@@ -135,74 +1131,421 @@ size_t getMaxBitSetCapacity(const BitSet *bitSetA, const BitSet *bitSetB) {
                                                : bitSetB->capacity;
 }
 
-BitSet getBitSetsUnion(const BitSet *bitSetA, const BitSet *bitSetB) {
-  const size_t maxCapacity = getMaxBitSetCapacity(bitSetA, bitSetB);
+/*
+  Fills the result block by block, visiting only the blocks that can be
+  non-empty according to the summaries and active ranges of the operands.
+  The result gets its own summary and active range if any of the operands
+  has one
+*/
+static BitSet combineBitSets(const BitSet *bitSetA, const BitSet *bitSetB,
+                             const size_t capacity,
+                             const BlockOperation operation) {
+  BitSet resultBitSet = createBitSet(capacity);
+  BaseErrorCode statusCode = NONE_ERROR;
 
-  const BitSet resultBitSet = createBitSet(maxCapacity);
+  // The result starts empty, so the summary and the range need no scan
+  if (resultBitSet.bits != NULL &&
+      (bitSetA->summary != NULL || bitSetB->summary != NULL)) {
+    statusCode = createSummary(&resultBitSet);
+  }
+  if (!statusCode && resultBitSet.bits != NULL &&
+      (bitSetA->activeRange != NULL || bitSetB->activeRange != NULL)) {
+    statusCode = createActiveRange(&resultBitSet);
+  }
+  if (statusCode) {
+    destroyBitSet(&resultBitSet);
+  }
+
+  size_t firstInA = 0;
+  size_t endInA = 0;
+  size_t firstInB = 0;
+  size_t endInB = 0;
+  getActiveBlocks(bitSetA, &firstInA, &endInA);
+  getActiveBlocks(bitSetB, &firstInB, &endInB);
+
+  size_t firstBlock;
+  size_t endBlock;
+  switch (operation) {
+    case INTERSECTION_OPERATION:
+      firstBlock = getMaxSize(firstInA, firstInB);
+      endBlock = getMinSize(endInA, endInB);
+      break;
+    case DIFFERENCE_OPERATION:
+      firstBlock = firstInA;
+      endBlock = endInA;
+      break;
+    default:
+      coverActiveBlocks(firstInA, endInA, firstInB, endInB, &firstBlock,
+                        &endBlock);
+  }
+  endBlock = resultBitSet.bits != NULL
+                 ? getMinSize(endBlock, resultBitSet.size)
+                 : 0;
+
+  const size_t endWord = firstBlock < endBlock ? getSummarySize(endBlock) : 0;
+
+  for (size_t wordPos = firstBlock / BIT_PER_BLOCK; wordPos < endWord;
+       wordPos++) {
+    const uint64_t summaryInA = getBitSetSummaryWord(bitSetA, wordPos);
+    const uint64_t summaryInB = getBitSetSummaryWord(bitSetB, wordPos);
 
-  for (size_t iter = 0; iter < resultBitSet.size; iter++) {
-    uint64_t blockInA = iter < bitSetA->size ? bitSetA->bits[iter] : 0;
-    uint64_t blockInB = iter < bitSetB->size ? bitSetB->bits[iter] : 0;
-    resultBitSet.bits[iter] = blockInA | blockInB;
+    uint64_t candidates = getBlocksMask(resultBitSet.size, wordPos);
+    switch (operation) {
+      case INTERSECTION_OPERATION:
+        candidates &= summaryInA & summaryInB;
+        break;
+      case DIFFERENCE_OPERATION:
+        candidates &= summaryInA;
+        break;
+      default:
+        candidates &= summaryInA | summaryInB;
+    }
+
+    while (candidates != 0) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      const size_t iter = wordPos * BIT_PER_BLOCK + leadingZeros;
+      candidates &= ~getPositionMask(leadingZeros);
+
+      uint64_t blockInA = iter < bitSetA->size ? bitSetA->bits[iter] : 0;
+      uint64_t blockInB = iter < bitSetB->size ? bitSetB->bits[iter] : 0;
+      uint64_t resultBlock;
+      switch (operation) {
+        case UNION_OPERATION:
+          resultBlock = blockInA | blockInB;
+          break;
+        case INTERSECTION_OPERATION:
+          resultBlock = blockInA & blockInB;
+          break;
+        case DIFFERENCE_OPERATION:
+          resultBlock = blockInA & ~blockInB;
+          break;
+        default:
+          resultBlock = blockInA ^ blockInB;
+      }
+      resultBitSet.bits[iter] = resultBlock;
+
+      if (resultBlock != 0) {
+        if (resultBitSet.summary != NULL) {
+          resultBitSet.summary[wordPos] |= getPositionMask(leadingZeros);
+        }
+        extendActiveRange(&resultBitSet, iter);
+      }
+    }
   }
 
   return resultBitSet;
 }
 
+BitSet getBitSetsUnion(const BitSet *bitSetA, const BitSet *bitSetB) {
+  const size_t maxCapacity = getMaxBitSetCapacity(bitSetA, bitSetB);
+
+  return combineBitSets(bitSetA, bitSetB, maxCapacity, UNION_OPERATION);
+}
+
 BitSet getBitSetsIntersection(const BitSet *bitSetA, const BitSet *bitSetB) {
   const size_t maxCapacity = getMaxBitSetCapacity(bitSetA, bitSetB);
 
-  const BitSet resultBitSet = createBitSet(maxCapacity);
+  return combineBitSets(bitSetA, bitSetB, maxCapacity, INTERSECTION_OPERATION);
+}
 
-  for (size_t iter = 0; iter < resultBitSet.size; iter++) {
-    uint64_t blockInA = iter < bitSetA->size ? bitSetA->bits[iter] : 0;
-    uint64_t blockInB = iter < bitSetB->size ? bitSetB->bits[iter] : 0;
-    resultBitSet.bits[iter] = blockInA & blockInB;
-  }
+BitSet getBitSetsDiff(const BitSet *bitSetA, const BitSet *bitSetB) {
+  return combineBitSets(bitSetA, bitSetB, bitSetA->capacity,
+                        DIFFERENCE_OPERATION);
+}
+
+BitSet getSymmetricBitSetsDiff(const BitSet *bitSetA, const BitSet *bitSetB) {
+  const size_t maxCapacity = getMaxBitSetCapacity(bitSetA, bitSetB);
 
+  return combineBitSets(bitSetA, bitSetB, maxCapacity,
+                        SYMMETRIC_DIFFERENCE_OPERATION);
+}
+
+BitSet getBitSetComplement(const BitSet *bitSet) {
+  BitSet resultBitSet = createBitSet(bitSet->capacity);
+
+  if (resultBitSet.bits != NULL) {
+    size_t firstBlock = 0;
+    size_t endBlock = 0;
+    getActiveBlocks(bitSet, &firstBlock, &endBlock);
+
+    // Outside the active range the blocks are zero, so they become full
+    memset(resultBitSet.bits, 0xFF, resultBitSet.size * sizeof(uint64_t));
+    for (size_t iter = firstBlock; iter < endBlock; ++iter) {
+      resultBitSet.bits[iter] = ~bitSet->bits[iter];
+    }
+
+    resultBitSet.bits[resultBitSet.size - 1] &=
+        getValidBitsMask(&resultBitSet, resultBitSet.size - 1);
+
+    if (bitSet->summary != NULL) {
+      enableBitSetSummary(&resultBitSet);
+    }
+    if (bitSet->activeRange != NULL) {
+      enableBitSetActiveRange(&resultBitSet);
+    }
+  }
   return resultBitSet;
 }
 
-BitSet getBitSetsDiff(const BitSet *bitSetA, const BitSet *bitSetB) {
-  const BitSet resultBitSet = createBitSet(bitSetA->capacity);
+/*
+  Returns the block with the given number after moving all elements of
+  the blocks by offset. Each result block is funnel-shifted from two
+  neighbouring source blocks
+*/
+static uint64_t getShiftedBlock(const uint64_t *blocks, const size_t size,
+                                const size_t blockPos, const int64_t offset) {
+  const uint64_t distance = offset < 0 ? -(uint64_t)offset : (uint64_t)offset;
+  const uint64_t blockShift = distance / BIT_PER_BLOCK;
+  const int bitShift = (int)(distance % BIT_PER_BLOCK);
+  uint64_t block = 0;
+
+  if (offset >= 0 && blockShift <= blockPos) {
+    // Larger elements lie towards the least significant bits
+    const size_t sourcePos = blockPos - blockShift;
+    block = blocks[sourcePos] >> bitShift;
+    if (bitShift != 0 && sourcePos > 0) {
+      block |= blocks[sourcePos - 1] << (BIT_PER_BLOCK - bitShift);
+    }
+  } else if (offset < 0 && blockShift < size - blockPos) {
+    const size_t sourcePos = blockPos + blockShift;
+    block = blocks[sourcePos] << bitShift;
+    if (bitShift != 0 && sourcePos + 1 < size) {
+      block |= blocks[sourcePos + 1] >> (BIT_PER_BLOCK - bitShift);
+    }
+  }
+
+  return block;
+}
+
+/*
+  Writes the shifted blocks of the source into the target, which may be
+  the source itself. The order of the pass makes sure every source block
+  is read before it is overwritten
+*/
+static void shiftBlocks(const BitSet *source, const BitSet *target,
+                        const int64_t offset) {
+  const size_t size = source->size;
+
+  for (size_t iter = 0; iter < size; iter++) {
+    const size_t blockPos = offset >= 0 ? size - iter - 1 : iter;
+    target->bits[blockPos] =
+        getShiftedBlock(source->bits, size, blockPos, offset);
+  }
+
+  target->bits[size - 1] &= getValidBitsMask(target, size - 1);
+}
+
+/*
+  Returns the rotation in [0, capacity] which has the effect of offset
+*/
+static uint64_t getRotation(const BitSet *bitSet, const int64_t offset) {
+  const uint64_t universeSize = (uint64_t)bitSet->capacity + 1;
+  const uint64_t distance =
+      (offset < 0 ? -(uint64_t)offset : (uint64_t)offset) % universeSize;
+
+  return offset < 0 && distance != 0 ? universeSize - distance : distance;
+}
+
+/*
+  Writes the rotated blocks of the source into another set in two
+  funnel-shift passes. The elements below capacity + 1 - rotation move up
+  into the blocks from the rotation on, the rest wraps around into the
+  blocks below it. Only the block holding the rotation gets both parts
+*/
+static void rotateBlocks(const BitSet *source, const BitSet *target,
+                         const uint64_t rotation) {
+  const size_t size = source->size;
+  const int64_t wrapOffset =
+      (int64_t)rotation - (int64_t)((uint64_t)source->capacity + 1);
+  const size_t boundaryBlock = rotation / BIT_PER_BLOCK;
+  const size_t wrapEnd = (rotation + BIT_PER_BLOCK - 1) / BIT_PER_BLOCK;
+
+  for (size_t blockPos = boundaryBlock; blockPos < size; blockPos++) {
+    target->bits[blockPos] =
+        getShiftedBlock(source->bits, size, blockPos, (int64_t)rotation);
+  }
+
+  for (size_t blockPos = 0; blockPos < wrapEnd; blockPos++) {
+    const uint64_t block =
+        getShiftedBlock(source->bits, size, blockPos, wrapOffset);
+    target->bits[blockPos] =
+        blockPos == boundaryBlock ? target->bits[blockPos] | block : block;
+  }
+
+  target->bits[size - 1] &= getValidBitsMask(target, size - 1);
+}
 
-  for (size_t iter = 0; iter < resultBitSet.size; iter++) {
-    uint64_t blockInA = iter < bitSetA->size ? bitSetA->bits[iter] : 0;
-    uint64_t blockInB = iter < bitSetB->size ? bitSetB->bits[iter] : 0;
-    resultBitSet.bits[iter] = blockInA & ~blockInB;
+/*
+  Reverses the order of the bits, so that the first element of the block
+  becomes the last one
+*/
+static uint64_t reverseBits(uint64_t value) {
+  value = (value >> 1 & 0x5555555555555555ULL) |
+          (value & 0x5555555555555555ULL) << 1;
+  value = (value >> 2 & 0x3333333333333333ULL) |
+          (value & 0x3333333333333333ULL) << 2;
+  value = (value >> 4 & 0x0F0F0F0F0F0F0F0FULL) |
+          (value & 0x0F0F0F0F0F0F0F0FULL) << 4;
+
+  return __builtin_bswap64(value);
+}
+
+/*
+  Returns the 64 elements starting from position, the first of them in
+  the most significant bit. The elements must lie inside the blocks
+*/
+static uint64_t readBitsAt(const uint64_t *blocks, const uint64_t position) {
+  const size_t blockPos = position / BIT_PER_BLOCK;
+  const int bitShift = (int)(position % BIT_PER_BLOCK);
+  uint64_t bits = blocks[blockPos];
+
+  if (bitShift != 0) {
+    bits = bits << bitShift |
+           blocks[blockPos + 1] >> (BIT_PER_BLOCK - bitShift);
+  }
+
+  return bits;
+}
+
+static void writeBitsAt(uint64_t *blocks, const uint64_t position,
+                        const uint64_t bits) {
+  const size_t blockPos = position / BIT_PER_BLOCK;
+  const int bitShift = (int)(position % BIT_PER_BLOCK);
+
+  if (bitShift == 0) {
+    blocks[blockPos] = bits;
+  } else {
+    const uint64_t tailMask = ~0ULL >> bitShift;
+    blocks[blockPos] = (blocks[blockPos] & ~tailMask) | bits >> bitShift;
+    blocks[blockPos + 1] = (blocks[blockPos + 1] & tailMask) |
+                           bits << (BIT_PER_BLOCK - bitShift);
+  }
+}
+
+/*
+  Reverses the order of the elements of [from, to) in place. Whole words
+  are swapped from both ends, the middle bits one by one
+*/
+static void reverseBitRange(uint64_t *blocks, uint64_t from, uint64_t to) {
+  while (to - from >= 2 * BIT_PER_BLOCK) {
+    const uint64_t head = readBitsAt(blocks, from);
+    const uint64_t tail = readBitsAt(blocks, to - BIT_PER_BLOCK);
+
+    writeBitsAt(blocks, from, reverseBits(tail));
+    writeBitsAt(blocks, to - BIT_PER_BLOCK, reverseBits(head));
+    from += BIT_PER_BLOCK;
+    to -= BIT_PER_BLOCK;
+  }
+
+  for (; from + 1 < to; from++, to--) {
+    const uint64_t headMask = getPositionMask(from);
+    const uint64_t tailMask = getPositionMask(to - 1);
+    const bool isHeadSet = (blocks[from / BIT_PER_BLOCK] & headMask) != 0;
+    const bool isTailSet = (blocks[(to - 1) / BIT_PER_BLOCK] & tailMask) != 0;
+
+    if (isHeadSet != isTailSet) {
+      blocks[from / BIT_PER_BLOCK] ^= headMask;
+      blocks[(to - 1) / BIT_PER_BLOCK] ^= tailMask;
+    }
+  }
+}
+
+/*
+  Rebuilds the summary and the active range after the blocks were
+  rewritten as a whole
+*/
+static void refreshBitSetIndexes(const BitSet *bitSet) {
+  if (bitSet->summary != NULL) {
+    refreshBitSetSummary(bitSet);
+  }
+  if (bitSet->activeRange != NULL) {
+    refreshBitSetActiveRange(bitSet);
+  }
+}
+
+BaseErrorCode shiftBitSet(const BitSet *bitSet, const int64_t offset) {
+  shiftBlocks(bitSet, bitSet, offset);
+  refreshBitSetIndexes(bitSet);
+
+  return NONE_ERROR;
+}
+
+BaseErrorCode shiftBitSetInto(const BitSet *bitSet, const int64_t offset,
+                              const BitSet *target) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  if (target->capacity != bitSet->capacity) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    shiftBlocks(bitSet, target, offset);
+    refreshBitSetIndexes(target);
+  }
+
+  return statusCode;
+}
+
+BitSet getShiftedBitSet(const BitSet *bitSet, const int64_t offset) {
+  BitSet resultBitSet = createBitSet(bitSet->capacity);
+
+  if (resultBitSet.bits != NULL) {
+    shiftBlocks(bitSet, &resultBitSet, offset);
+
+    if (bitSet->summary != NULL) {
+      enableBitSetSummary(&resultBitSet);
+    }
+    if (bitSet->activeRange != NULL) {
+      enableBitSetActiveRange(&resultBitSet);
+    }
   }
 
   return resultBitSet;
 }
 
-BitSet getSymmetricBitSetsDiff(const BitSet *bitSetA, const BitSet *bitSetB) {
-  const size_t maxCapacity = getMaxBitSetCapacity(bitSetA, bitSetB);
+BitSet getRotatedBitSet(const BitSet *bitSet, const int64_t offset) {
+  BitSet resultBitSet = createBitSet(bitSet->capacity);
 
-  const BitSet resultBitSet = createBitSet(maxCapacity);
+  if (resultBitSet.bits != NULL) {
+    rotateBlocks(bitSet, &resultBitSet, getRotation(bitSet, offset));
 
-  for (size_t iter = 0; iter < resultBitSet.size; iter++) {
-    uint64_t blockInA = iter < bitSetA->size ? bitSetA->bits[iter] : 0;
-    uint64_t blockInB = iter < bitSetB->size ? bitSetB->bits[iter] : 0;
-    resultBitSet.bits[iter] = blockInA ^ blockInB;
+    if (bitSet->summary != NULL) {
+      enableBitSetSummary(&resultBitSet);
+    }
+    if (bitSet->activeRange != NULL) {
+      enableBitSetActiveRange(&resultBitSet);
+    }
   }
 
   return resultBitSet;
 }
 
-BitSet getBitSetComplement(const BitSet *bitSet) {
-  const BitSet resultBitSet = createBitSet(bitSet->capacity);
+BaseErrorCode rotateBitSetInto(const BitSet *bitSet, const int64_t offset,
+                               const BitSet *target) {
+  BaseErrorCode statusCode = NONE_ERROR;
 
-  for (size_t iter = 0; iter < resultBitSet.size; ++iter) {
-    resultBitSet.bits[iter] = ~bitSet->bits[iter];
+  if (target->capacity != bitSet->capacity || target->bits == bitSet->bits) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    rotateBlocks(bitSet, target, getRotation(bitSet, offset));
+    refreshBitSetIndexes(target);
   }
 
-  const size_t totalBits = resultBitSet.size * BIT_PER_BLOCK;
-  const size_t excessBits = totalBits - resultBitSet.capacity;
-  if (excessBits > 0) {
-    const uint64_t mask = ~(1ULL << (BIT_PER_BLOCK - excessBits - 1));
-    resultBitSet.bits[resultBitSet.size - 1] &= mask;
+  return statusCode;
+}
+
+BaseErrorCode rotateBitSet(const BitSet *bitSet, const int64_t offset) {
+  const uint64_t universeSize = (uint64_t)bitSet->capacity + 1;
+  const uint64_t rotation = getRotation(bitSet, offset);
+
+  // Reversing the whole universe and then both of its parts moves the
+  // last rotation elements to the front without extra memory
+  if (rotation != 0) {
+    reverseBitRange(bitSet->bits, 0, universeSize);
+    reverseBitRange(bitSet->bits, 0, rotation);
+    reverseBitRange(bitSet->bits, rotation, universeSize);
+    refreshBitSetIndexes(bitSet);
   }
-  return resultBitSet;
+
+  return NONE_ERROR;
 }
 
 BaseErrorCode printBitSet(const BitSet *bitSet, outputFunc output) {
@@ -215,21 +1558,42 @@ BaseErrorCode printBitSet(const BitSet *bitSet, outputFunc output) {
     statusCode = MEMORY_ALLOCATION_ERROR;
   }
 
-  for (uint64_t number = 0; number <= (uint64_t)bitSet->capacity; number++) {
-    if (isBitSetContains(bitSet, number)) {
-      const uint64_t requiredSize = snprintf(NULL, 0, "%ld", number);
-      if (currentBufferSize + requiredSize >= maxBufferSize) {
-        maxBufferSize *= 2;
-        buffer = realloc(buffer, maxBufferSize);
-        if (buffer == NULL) {
-          statusCode = MEMORY_ALLOCATION_ERROR;
+  size_t firstWord = 0;
+  size_t endWord = 0;
+  getActiveWords(bitSet, &firstWord, &endWord);
+
+  for (size_t wordPos = firstWord; wordPos < endWord; wordPos++) {
+    uint64_t candidates = getBitSetSummaryWord(bitSet, wordPos);
+
+    while (candidates != 0) {
+      const int leadingBlocks = __builtin_clzll(candidates);
+      const size_t blockPos = wordPos * BIT_PER_BLOCK + leadingBlocks;
+      candidates &= ~getPositionMask(leadingBlocks);
+
+      uint64_t block = bitSet->bits[blockPos];
+      while (block != 0) {
+        const int leadingZeros = __builtin_clzll(block);
+        const uint64_t number = blockPos * BIT_PER_BLOCK + leadingZeros;
+        block &= ~getPositionMask(leadingZeros);
+
+        if (number > (uint64_t)bitSet->capacity) {
+          continue;
         }
-      }
 
-      if (!statusCode) {
-        currentBufferSize +=
-            snprintf(buffer + currentBufferSize,
-                     maxBufferSize - currentBufferSize, "%ld, ", number);
+        const uint64_t requiredSize = snprintf(NULL, 0, "%ld", number);
+        if (currentBufferSize + requiredSize >= maxBufferSize) {
+          maxBufferSize *= 2;
+          buffer = realloc(buffer, maxBufferSize);
+          if (buffer == NULL) {
+            statusCode = MEMORY_ALLOCATION_ERROR;
+          }
+        }
+
+        if (!statusCode) {
+          currentBufferSize +=
+              snprintf(buffer + currentBufferSize,
+                       maxBufferSize - currentBufferSize, "%ld, ", number);
+        }
       }
     }
   }
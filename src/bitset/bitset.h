@@ -15,10 +15,18 @@
 
 typedef void (*outputFunc)(const char *);
 
+typedef struct BitSetActiveRange {
+  size_t firstBlock;  // No block before it is non-zero
+  size_t lastBlock;   // No block after it is non-zero
+  bool isStale;       // Blocks on the bounds may have become zero
+} BitSetActiveRange;
+
 typedef struct BitSet {
-  uint64_t *bits;   // Dynamic block of bits
-  size_t size;      // Number of blocks
-  size_t capacity;  // Maximum number of elements
+  uint64_t *bits;     // Dynamic block of bits
+  size_t size;        // Number of blocks
+  size_t capacity;    // Maximum number of elements
+  uint64_t *summary;  // Optional index: one bit per non-zero block
+  BitSetActiveRange *activeRange;  // Optional bounds of the non-zero blocks
 } BitSet;
 
 /*
@@ -27,11 +35,63 @@ typedef struct BitSet {
 */
 BitSet createBitSet(size_t capacity);
 
+/*
+  Same as createBitSet, but the blocks start at a multiple of alignment
+  bytes, which must be a power of two. The set is removed as usual
+*/
+BitSet createAlignedBitSet(size_t capacity, size_t alignment);
+
+/*
+  Creates an independent copy of the set, including its summary
+*/
+BitSet copyBitSet(const BitSet *bitSet);
+
 /*
   Removes the BitSet structure
 */
 void destroyBitSet(BitSet *bitSet);
 
+/*
+  Builds the summary index of the set. Afterwards add and remove keep it
+  up to date, and operations skip the blocks which are marked as empty
+*/
+BaseErrorCode enableBitSetSummary(BitSet *bitSet);
+
+/*
+  Frees the summary index of the set
+*/
+void disableBitSetSummary(BitSet *bitSet);
+
+/*
+  Starts tracking the lowest and highest non-zero blocks of the set.
+  Operations then work only on the blocks between them
+*/
+BaseErrorCode enableBitSetActiveRange(BitSet *bitSet);
+
+/*
+  Stops tracking the non-zero blocks of the set
+*/
+void disableBitSetActiveRange(BitSet *bitSet);
+
+/*
+  Returns the number of words in the summary of the set
+*/
+size_t getBitSetSummarySize(const BitSet *bitSet);
+
+/*
+  Returns the word of the summary with the given number, block i is
+  described by bit 63 - i % 64 of word i / 64. Without the summary,
+  all existing blocks are considered non-empty. Blocks outside the
+  active range are always reported empty
+*/
+uint64_t getBitSetSummaryWord(const BitSet *bitSet, size_t wordPos);
+
+/*
+  Replaces the block with the given number and keeps the summary
+  up to date. Bits beyond the capacity are dropped
+*/
+void setBitSetBlock(const BitSet *bitSet, size_t blockPos, uint64_t block);
+
 /*
   Adds a number in set if it is positive
   and permissible, otherwise it passes it
@@ -45,6 +105,24 @@ BaseErrorCode addBitSetElement(const BitSet *bitSet, uint64_t element);
 BaseErrorCode addManyBitSetElements(const BitSet *bitSet, size_t count,
                                 const uint64_t elements[]);
 
+/*
+  Adds all elements of the source set to the target set, the target
+  becomes target ∪ source. Elements beyond the target capacity are
+  skipped and CAPACITY_EXCEEDING_ERROR returns
+*/
+BaseErrorCode mergeBitSets(const BitSet *target, const BitSet *source);
+
+/*
+  Adds all numbers of [from, to) to the set
+*/
+BaseErrorCode addBitSetRange(const BitSet *bitSet, uint64_t from, uint64_t to);
+
+/*
+  Removes all numbers of [from, to) from the set
+*/
+BaseErrorCode removeBitSetRange(const BitSet *bitSet, uint64_t from,
+                                uint64_t to);
+
 /*
   Removes an element from the set
 */
@@ -55,11 +133,98 @@ BaseErrorCode removeBitSetElement(const BitSet *bitSet, uint64_t element);
 */
 bool isBitSetContains(const BitSet *bitSet, uint64_t element);
 
+/*
+  Keeps in the array only the numbers which are in the set, preserving
+  their order, and returns how many were kept. The array may be unsorted
+*/
+size_t filterBitSetElements(const BitSet *bitSet, size_t count,
+                            uint64_t elements[]);
+
+/*
+  Leaves in the set only the numbers of the ascending array. If the array
+  is not sorted, INVALID_ARGUMENT_ERROR returns and the set is unchanged
+*/
+BaseErrorCode intersectBitSetWithSortedElements(const BitSet *bitSet,
+                                                size_t count,
+                                                const uint64_t elements[]);
+
+/*
+  Adds the numbers of the ascending array to the set, one block at a time.
+  Numbers beyond the capacity are skipped with CAPACITY_EXCEEDING_ERROR.
+  If the array is not sorted, INVALID_ARGUMENT_ERROR returns and the set
+  is unchanged
+*/
+BaseErrorCode mergeSortedElementsIntoBitSet(const BitSet *bitSet, size_t count,
+                                            const uint64_t elements[]);
+
+/*
+  Returns the number of elements in the set
+*/
+size_t getBitSetCount(const BitSet *bitSet);
+
+/*
+  Checks whether the set has no elements
+*/
+bool isBitSetEmpty(const BitSet *bitSet);
+
+/*
+  Writes the smallest element of the set.
+  If the set is empty, ELEMENT_NOT_FOUND_ERROR returns
+*/
+BaseErrorCode findFirstBitSetElement(const BitSet *bitSet, uint64_t *element);
+
+/*
+  Writes the largest element of the set.
+  If the set is empty, ELEMENT_NOT_FOUND_ERROR returns
+*/
+BaseErrorCode findLastBitSetElement(const BitSet *bitSet, uint64_t *element);
+
+/*
+  Writes the smallest number in [0, capacity] which is not in the set.
+  If the set is full, ELEMENT_NOT_FOUND_ERROR returns
+*/
+BaseErrorCode findFirstBitSetFreeElement(const BitSet *bitSet,
+                                         uint64_t *element);
+
+/*
+  Writes the first number not in the set starting from the hint.
+  The search wraps around to zero after the capacity
+*/
+BaseErrorCode findNextBitSetFreeElement(const BitSet *bitSet, uint64_t hint,
+                                        uint64_t *element);
+
+/*
+  Atomically adds the smallest number which is not in the set
+  and writes it. Safe to call from several threads at once
+*/
+BaseErrorCode allocateBitSetElement(const BitSet *bitSet, uint64_t *element);
+
+/*
+  Same as allocateBitSetElement, but the search starts from the hint and
+  wraps around to zero. Passing the last number plus one as the next hint
+  skips the blocks filled before it
+*/
+BaseErrorCode allocateNextBitSetElement(const BitSet *bitSet, uint64_t hint,
+                                        uint64_t *element);
+
+/*
+  Atomically adds count consecutive numbers which are not in the set
+  and writes the first of them
+*/
+BaseErrorCode allocateBitSetRange(const BitSet *bitSet, size_t count,
+                                  uint64_t *first);
+
 /*
   Checks whether two sets are equal
 */
 bool isBitSetsEqual(const BitSet *, const BitSet *);
 
+/*
+  Returns a hash of the set contents and capacity.
+  Equal sets always have equal hashes
+*/
+uint64_t getBitSetHash(const BitSet *bitSet);
+
 /*
   Checks whether setA ⊆ setВ
 */
@@ -100,6 +265,44 @@ BitSet getSymmetricBitSetsDiff(const BitSet *bitSetA, const BitSet *bitSetB);
 */
 BitSet getBitSetComplement(const BitSet *);
 
+/*
+  Adds offset to every element of the set in place. Elements which
+  leave [0, capacity] are dropped
+*/
+BaseErrorCode shiftBitSet(const BitSet *bitSet, int64_t offset);
+
+/*
+  Creates a set with every element of this set moved by offset.
+  Elements which leave [0, capacity] are dropped
+*/
+BitSet getShiftedBitSet(const BitSet *bitSet, int64_t offset);
+
+/*
+  Writes the set with every element moved by offset into the target,
+  which must have the same capacity and may be the set itself
+*/
+BaseErrorCode shiftBitSetInto(const BitSet *bitSet, int64_t offset,
+                              const BitSet *target);
+
+/*
+  Moves every element by offset in place, wrapping around
+  in [0, capacity]. No extra memory is allocated
+*/
+BaseErrorCode rotateBitSet(const BitSet *bitSet, int64_t offset);
+
+/*
+  Creates a set with every element of this set moved by offset,
+  wrapping around in [0, capacity]
+*/
+BitSet getRotatedBitSet(const BitSet *bitSet, int64_t offset);
+
+/*
+  Writes the set with every element moved by offset, wrapping around in
+  [0, capacity], into another set of the same capacity
+*/
+BaseErrorCode rotateBitSetInto(const BitSet *bitSet, int64_t offset,
+                               const BitSet *target);
+
 /*
   Displays a set to the function for showing
 */
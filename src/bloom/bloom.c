@@ -0,0 +1,277 @@
+#include "bloom.h"
+
+#include <math.h>
+
+#define BLOOM_BATCH_SIZE 16
+#define BLOCKS_PER_LINE (BLOOM_LINE_BITS / BIT_PER_BLOCK)
+
+typedef struct BloomProbe {
+  uint64_t lineStart;  // First element of the line
+  uint64_t bitHash;    // Source of the bit positions inside the line
+} BloomProbe;
+
+static uint64_t mixKey(uint64_t key) {
+  key += 0x9E3779B97F4A7C15ULL;
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+
+  return key ^ (key >> 31);
+}
+
+static BloomProbe getBloomProbe(const BloomFilter *filter, const uint64_t key) {
+  BloomProbe probe;
+  const uint64_t hash = mixKey(key);
+
+  probe.lineStart = (hash % filter->lineCount) * BLOOM_LINE_BITS;
+  probe.bitHash = mixKey(hash);
+
+  return probe;
+}
+
+/*
+  Returns the element of the i-th bit of the key, the positions inside
+  the line are generated by double hashing
+*/
+static uint64_t getProbeElement(const BloomProbe *probe, const size_t iter) {
+  const uint32_t first = (uint32_t)probe->bitHash;
+  const uint32_t step = (uint32_t)(probe->bitHash >> 32) | 1;
+
+  return probe->lineStart + (first + iter * step) % BLOOM_LINE_BITS;
+}
+
+static void prefetchBloomLine(const BloomFilter *filter,
+                              const BloomProbe *probe) {
+  __builtin_prefetch(&filter->bitSet.bits[probe->lineStart / BIT_PER_BLOCK]);
+}
+
+BloomFilter createBloomFilter(const size_t bitCount, const size_t hashCount) {
+  BloomFilter filter;
+
+  filter.lineCount = (bitCount + BLOOM_LINE_BITS - 1) / BLOOM_LINE_BITS;
+  filter.lineCount = filter.lineCount > 0 ? filter.lineCount : 1;
+  filter.hashCount = hashCount > 0 ? hashCount : 1;
+  filter.hashCount = filter.hashCount < BLOOM_MAX_HASH_COUNT
+                         ? filter.hashCount
+                         : BLOOM_MAX_HASH_COUNT;
+  filter.bitSet = createAlignedBitSet(filter.lineCount * BLOOM_LINE_BITS - 1,
+                                      BLOOM_LINE_BYTES);
+
+  return filter;
+}
+
+void destroyBloomFilter(BloomFilter *filter) {
+  destroyBitSet(&filter->bitSet);
+  filter->lineCount = 0;
+  filter->hashCount = 0;
+}
+
+static void addBloomProbe(const BloomFilter *filter, const BloomProbe *probe) {
+  for (size_t iter = 0; iter < filter->hashCount; iter++) {
+    addBitSetElement(&filter->bitSet, getProbeElement(probe, iter));
+  }
+}
+
+static bool isBloomProbeContains(const BloomFilter *filter,
+                                 const BloomProbe *probe) {
+  bool isContains = true;
+  for (size_t iter = 0; iter < filter->hashCount; iter++) {
+    isContains &= isBitSetContains(&filter->bitSet, getProbeElement(probe, iter));
+  }
+
+  return isContains;
+}
+
+void addBloomFilterKey(const BloomFilter *filter, const uint64_t key) {
+  const BloomProbe probe = getBloomProbe(filter, key);
+  addBloomProbe(filter, &probe);
+}
+
+void addManyBloomFilterKeys(const BloomFilter *filter, const size_t count,
+                            const uint64_t keys[]) {
+  BloomProbe probes[BLOOM_BATCH_SIZE];
+
+  for (size_t batchStart = 0; batchStart < count;
+       batchStart += BLOOM_BATCH_SIZE) {
+    const size_t batchSize = count - batchStart < BLOOM_BATCH_SIZE
+                                 ? count - batchStart
+                                 : BLOOM_BATCH_SIZE;
+
+    // All lines of the batch are requested before the first one is used
+    for (size_t iter = 0; iter < batchSize; iter++) {
+      probes[iter] = getBloomProbe(filter, keys[batchStart + iter]);
+      prefetchBloomLine(filter, &probes[iter]);
+    }
+    for (size_t iter = 0; iter < batchSize; iter++) {
+      addBloomProbe(filter, &probes[iter]);
+    }
+  }
+}
+
+bool isBloomFilterContains(const BloomFilter *filter, const uint64_t key) {
+  const BloomProbe probe = getBloomProbe(filter, key);
+  return isBloomProbeContains(filter, &probe);
+}
+
+void queryManyBloomFilterKeys(const BloomFilter *filter, const size_t count,
+                              const uint64_t keys[], bool results[]) {
+  BloomProbe probes[BLOOM_BATCH_SIZE];
+
+  for (size_t batchStart = 0; batchStart < count;
+       batchStart += BLOOM_BATCH_SIZE) {
+    const size_t batchSize = count - batchStart < BLOOM_BATCH_SIZE
+                                 ? count - batchStart
+                                 : BLOOM_BATCH_SIZE;
+
+    for (size_t iter = 0; iter < batchSize; iter++) {
+      probes[iter] = getBloomProbe(filter, keys[batchStart + iter]);
+      prefetchBloomLine(filter, &probes[iter]);
+    }
+    for (size_t iter = 0; iter < batchSize; iter++) {
+      results[batchStart + iter] = isBloomProbeContains(filter, &probes[iter]);
+    }
+  }
+}
+
+double estimateBloomFilterCount(const BloomFilter *filter) {
+  const double bitCount = (double)filter->lineCount * BLOOM_LINE_BITS;
+  const double setBits = (double)getBitSetCount(&filter->bitSet);
+
+  double estimate = bitCount;
+  if (setBits < bitCount) {
+    estimate = -bitCount / (double)filter->hashCount * log(1.0 - setBits / bitCount);
+  }
+
+  return estimate;
+}
+
+static bool isBloomFiltersCompatible(const BloomFilter *filterA,
+                                     const BloomFilter *filterB) {
+  return filterA->lineCount == filterB->lineCount &&
+         filterA->hashCount == filterB->hashCount;
+}
+
+/*
+  Creates an empty aligned filter with the layout of both filters
+*/
+static BaseErrorCode createResultFilter(const BloomFilter *filterA,
+                                        const BloomFilter *filterB,
+                                        BloomFilter *resultFilter) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  if (!isBloomFiltersCompatible(filterA, filterB)) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    *resultFilter = createBloomFilter(filterA->lineCount * BLOOM_LINE_BITS,
+                                      filterA->hashCount);
+
+    if (resultFilter->bitSet.bits == NULL) {
+      statusCode = MEMORY_ALLOCATION_ERROR;
+    }
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode getBloomFiltersUnion(const BloomFilter *filterA,
+                                   const BloomFilter *filterB,
+                                   BloomFilter *resultFilter) {
+  BaseErrorCode statusCode =
+      createResultFilter(filterA, filterB, resultFilter);
+
+  // The sets have the same capacity, so merging cannot fail
+  if (!statusCode) {
+    mergeBitSets(&resultFilter->bitSet, &filterA->bitSet);
+    mergeBitSets(&resultFilter->bitSet, &filterB->bitSet);
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode getBloomFiltersIntersection(const BloomFilter *filterA,
+                                          const BloomFilter *filterB,
+                                          BloomFilter *resultFilter) {
+  BaseErrorCode statusCode =
+      createResultFilter(filterA, filterB, resultFilter);
+
+  if (!statusCode) {
+    for (size_t blockPos = 0; blockPos < resultFilter->bitSet.size;
+         blockPos++) {
+      resultFilter->bitSet.bits[blockPos] =
+          filterA->bitSet.bits[blockPos] & filterB->bitSet.bits[blockPos];
+    }
+  }
+
+  return statusCode;
+}
+
+static void writeLittleEndian(uint8_t *bytes, uint64_t value) {
+  for (size_t iter = 0; iter < sizeof(uint64_t); iter++) {
+    bytes[iter] = (uint8_t)(value >> (8 * iter));
+  }
+}
+
+static uint64_t readLittleEndian(const uint8_t *bytes) {
+  uint64_t value = 0;
+  for (size_t iter = 0; iter < sizeof(uint64_t); iter++) {
+    value |= (uint64_t)bytes[iter] << (8 * iter);
+  }
+
+  return value;
+}
+
+BaseErrorCode serializeBloomFilter(const BloomFilter *filter, uint8_t **data,
+                                   size_t *length) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  *length = BLOOM_HEADER_SIZE + filter->bitSet.size * sizeof(uint64_t);
+  *data = malloc(*length);
+
+  if (*data == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+    *length = 0;
+  } else {
+    writeLittleEndian(*data, filter->lineCount);
+    writeLittleEndian(*data + sizeof(uint64_t), filter->hashCount);
+
+    for (size_t blockPos = 0; blockPos < filter->bitSet.size; blockPos++) {
+      writeLittleEndian(*data + BLOOM_HEADER_SIZE + blockPos * sizeof(uint64_t),
+                        filter->bitSet.bits[blockPos]);
+    }
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode deserializeBloomFilter(const uint8_t *data, const size_t length,
+                                     BloomFilter *filter) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  uint64_t lineCount = 0;
+  uint64_t hashCount = 0;
+
+  if (length >= BLOOM_HEADER_SIZE) {
+    lineCount = readLittleEndian(data);
+    hashCount = readLittleEndian(data + sizeof(uint64_t));
+  }
+
+  const uint64_t blockCount = (length - BLOOM_HEADER_SIZE) / sizeof(uint64_t);
+  if (length < BLOOM_HEADER_SIZE || lineCount == 0 || hashCount == 0 ||
+      hashCount > BLOOM_MAX_HASH_COUNT ||
+      blockCount / BLOCKS_PER_LINE != lineCount ||
+      blockCount % BLOCKS_PER_LINE != 0 ||
+      (length - BLOOM_HEADER_SIZE) % sizeof(uint64_t) != 0) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    *filter = createBloomFilter(lineCount * BLOOM_LINE_BITS, hashCount);
+
+    if (filter->bitSet.bits == NULL) {
+      statusCode = MEMORY_ALLOCATION_ERROR;
+    } else {
+      for (size_t blockPos = 0; blockPos < filter->bitSet.size; blockPos++) {
+        filter->bitSet.bits[blockPos] = readLittleEndian(
+            data + BLOOM_HEADER_SIZE + blockPos * sizeof(uint64_t));
+      }
+    }
+  }
+
+  return statusCode;
+}
@@ -0,0 +1,98 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+#define BLOOM_LINE_BITS 512
+#define BLOOM_LINE_BYTES (BLOOM_LINE_BITS / 8)
+#define BLOOM_HEADER_SIZE 16
+#define BLOOM_MAX_HASH_COUNT 64
+
+/*
+  Blocked Bloom filter: every key sets all of its bits inside one
+  512-bit line, so a lookup reads a single cache line
+*/
+typedef struct BloomFilter {
+  BitSet bitSet;     // Lines stored one after another
+  size_t lineCount;  // Number of lines
+  size_t hashCount;  // Number of bits set per key
+} BloomFilter;
+
+/*
+  Creates a filter with at least bitCount bits and hashCount bits per key,
+  which is limited by BLOOM_MAX_HASH_COUNT. Every line lies on its own
+  cache line, so a lookup misses once at most.
+  In case of error, the bits of the inner set are NULL
+*/
+BloomFilter createBloomFilter(size_t bitCount, size_t hashCount);
+
+/*
+  Removes the BloomFilter structure
+*/
+void destroyBloomFilter(BloomFilter *filter);
+
+/*
+  Adds a key to the filter
+*/
+void addBloomFilterKey(const BloomFilter *filter, uint64_t key);
+
+/*
+  Adds several keys, the lines of the batch are prefetched in advance
+*/
+void addManyBloomFilterKeys(const BloomFilter *filter, size_t count,
+                            const uint64_t keys[]);
+
+/*
+  Checks if the key may be in the filter. False positives are possible,
+  false negatives are not
+*/
+bool isBloomFilterContains(const BloomFilter *filter, uint64_t key);
+
+/*
+  Checks several keys and writes the answers to results
+*/
+void queryManyBloomFilterKeys(const BloomFilter *filter, size_t count,
+                              const uint64_t keys[], bool results[]);
+
+/*
+  Estimates the number of distinct keys added to the filter
+*/
+double estimateBloomFilterCount(const BloomFilter *filter);
+
+/*
+  Creates a filter with the keys of both filters. The filters must have
+  the same size and number of bits per key
+*/
+BaseErrorCode getBloomFiltersUnion(const BloomFilter *filterA,
+                                   const BloomFilter *filterB,
+                                   BloomFilter *resultFilter);
+
+/*
+  Creates a filter which approximates the keys present in both filters.
+  BitSet has no in-place intersection, and getBitSetsIntersection would
+  allocate unaligned storage, so the aligned result is filled block by block
+*/
+BaseErrorCode getBloomFiltersIntersection(const BloomFilter *filterA,
+                                          const BloomFilter *filterB,
+                                          BloomFilter *resultFilter);
+
+/*
+  Writes the filter as little-endian line count, hash count and blocks.
+  The data is allocated and must be freed by the caller
+*/
+BaseErrorCode serializeBloomFilter(const BloomFilter *filter, uint8_t **data,
+                                   size_t *length);
+
+/*
+  Creates a filter from the data written by serializeBloomFilter.
+  A hash count above BLOOM_MAX_HASH_COUNT is rejected as malformed
+*/
+BaseErrorCode deserializeBloomFilter(const uint8_t *data, size_t length,
+                                     BloomFilter *filter);
+
+#endif
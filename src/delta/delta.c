@@ -0,0 +1,320 @@
+#include "delta.h"
+
+#include <stdbool.h>
+
+#define MAX_VARINT_LENGTH 10
+
+typedef struct DeltaEntry {
+  uint64_t blockPos;
+  uint64_t mask;
+} DeltaEntry;
+
+typedef struct DeltaReader {
+  const BitSetDelta *delta;
+  size_t position;
+  uint64_t nextBlockPos;
+  uint64_t blockCount;  // Number of blocks of the encoded capacity
+} DeltaReader;
+
+static BaseErrorCode reserveDelta(BitSetDelta *delta, size_t *allocated,
+                                  const size_t required) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  if (delta->length + required > *allocated) {
+    size_t newSize = *allocated * 2;
+    while (newSize < delta->length + required) {
+      newSize *= 2;
+    }
+
+    uint8_t *data = realloc(delta->data, newSize);
+    if (data == NULL) {
+      statusCode = MEMORY_ALLOCATION_ERROR;
+    } else {
+      delta->data = data;
+      *allocated = newSize;
+    }
+  }
+
+  return statusCode;
+}
+
+static void writeVarint(BitSetDelta *delta, uint64_t value) {
+  while (value >= 0x80) {
+    delta->data[delta->length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  delta->data[delta->length++] = (uint8_t)value;
+}
+
+static bool readVarint(DeltaReader *reader, uint64_t *value) {
+  bool isRead = false;
+  uint64_t result = 0;
+  size_t shift = 0;
+
+  while (!isRead && shift < 7 * MAX_VARINT_LENGTH &&
+         reader->position < reader->delta->length) {
+    const uint8_t byte = reader->delta->data[reader->position++];
+    result |= (uint64_t)(byte & 0x7F) << shift;
+    shift += 7;
+    isRead = (byte & 0x80) == 0;
+  }
+
+  *value = result;
+  return isRead;
+}
+
+/*
+  Reverses the order of the bits, so that the first element of the block
+  becomes the least significant bit
+*/
+static uint64_t reverseBits(uint64_t value) {
+  value = (value >> 1 & 0x5555555555555555ULL) |
+          (value & 0x5555555555555555ULL) << 1;
+  value = (value >> 2 & 0x3333333333333333ULL) |
+          (value & 0x3333333333333333ULL) << 2;
+  value = (value >> 4 & 0x0F0F0F0F0F0F0F0FULL) |
+          (value & 0x0F0F0F0F0F0F0F0FULL) << 4;
+
+  return __builtin_bswap64(value);
+}
+
+static bool isDeltaFinished(const DeltaReader *reader) {
+  return reader->position >= reader->delta->length;
+}
+
+/*
+  Reads the next changed block. A gap leading past the last block of the
+  capacity is malformed, which also keeps the position from wrapping
+*/
+static bool readDeltaEntry(DeltaReader *reader, DeltaEntry *entry) {
+  uint64_t gap = 0;
+  uint64_t encodedMask = 0;
+  const bool isRead =
+      readVarint(reader, &gap) && readVarint(reader, &encodedMask) &&
+      gap < reader->blockCount - reader->nextBlockPos;
+
+  entry->mask = reverseBits(encodedMask);
+  entry->blockPos = reader->nextBlockPos + gap;
+  reader->nextBlockPos = entry->blockPos + 1;
+
+  return isRead;
+}
+
+/*
+  Starts reading the delta and writes its capacity
+*/
+static bool openDelta(DeltaReader *reader, const BitSetDelta *delta,
+                      uint64_t *capacity) {
+  reader->delta = delta;
+  reader->position = 0;
+  reader->nextBlockPos = 0;
+
+  const bool isRead = readVarint(reader, capacity);
+  reader->blockCount = *capacity / BIT_PER_BLOCK + 1;
+
+  return isRead;
+}
+
+/*
+  Starts a new delta with the given capacity
+*/
+static BaseErrorCode beginDelta(BitSetDelta *delta, size_t *allocated,
+                                const uint64_t capacity) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  *allocated = MIN_DELTA_SIZE;
+  delta->length = 0;
+  delta->data = malloc(*allocated);
+
+  if (delta->data == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  } else {
+    writeVarint(delta, capacity);
+  }
+
+  return statusCode;
+}
+
+static BaseErrorCode writeDeltaEntry(BitSetDelta *delta, size_t *allocated,
+                                     uint64_t *nextBlockPos,
+                                     const DeltaEntry *entry) {
+  const BaseErrorCode statusCode =
+      reserveDelta(delta, allocated, 2 * MAX_VARINT_LENGTH);
+
+  if (!statusCode) {
+    writeVarint(delta, entry->blockPos - *nextBlockPos);
+    writeVarint(delta, reverseBits(entry->mask));
+    *nextBlockPos = entry->blockPos + 1;
+  }
+
+  return statusCode;
+}
+
+/*
+  Encodes the changed blocks. Without the old set the new one is compared
+  with the empty set, so only its own non-empty blocks are read
+*/
+static BaseErrorCode encodeDelta(const BitSet *oldBitSet,
+                                 const BitSet *newBitSet, BitSetDelta *delta) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  size_t allocated = 0;
+  uint64_t nextBlockPos = 0;
+
+  delta->data = NULL;
+  delta->length = 0;
+
+  if (oldBitSet != NULL && oldBitSet->capacity != newBitSet->capacity) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    statusCode = beginDelta(delta, &allocated, newBitSet->capacity);
+  }
+
+  const size_t summarySize = getBitSetSummarySize(newBitSet);
+
+  for (size_t wordPos = 0; wordPos < summarySize && !statusCode; wordPos++) {
+    // Blocks empty in both versions cannot differ
+    uint64_t candidates = getBitSetSummaryWord(newBitSet, wordPos);
+    if (oldBitSet != NULL) {
+      candidates |= getBitSetSummaryWord(oldBitSet, wordPos);
+    }
+
+    while (candidates != 0 && !statusCode) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      candidates &= ~(1ULL << (BIT_PER_BLOCK - leadingZeros - 1));
+
+      DeltaEntry entry;
+      entry.blockPos = wordPos * BIT_PER_BLOCK + leadingZeros;
+      entry.mask = newBitSet->bits[entry.blockPos];
+      if (oldBitSet != NULL) {
+        entry.mask ^= oldBitSet->bits[entry.blockPos];
+      }
+
+      if (entry.mask != 0) {
+        statusCode = writeDeltaEntry(delta, &allocated, &nextBlockPos, &entry);
+      }
+    }
+  }
+
+  if (statusCode) {
+    destroyBitSetDelta(delta);
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode createBitSetDelta(const BitSet *oldBitSet,
+                                const BitSet *newBitSet, BitSetDelta *delta) {
+  return encodeDelta(oldBitSet, newBitSet, delta);
+}
+
+BaseErrorCode createBitSetDeltaFromEmpty(const BitSet *bitSet,
+                                         BitSetDelta *delta) {
+  return encodeDelta(NULL, bitSet, delta);
+}
+
+BaseErrorCode applyBitSetDelta(const BitSet *bitSet, const BitSetDelta *delta) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  DeltaReader reader;
+  DeltaEntry entry;
+  uint64_t capacity = 0;
+
+  // The first pass only validates, so a broken delta changes nothing
+  if (!openDelta(&reader, delta, &capacity) ||
+      capacity != (uint64_t)bitSet->capacity) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  }
+
+  while (!statusCode && !isDeltaFinished(&reader)) {
+    if (!readDeltaEntry(&reader, &entry) || entry.blockPos >= bitSet->size) {
+      statusCode = INVALID_ARGUMENT_ERROR;
+    }
+  }
+
+  if (!statusCode) {
+    openDelta(&reader, delta, &capacity);
+    while (!isDeltaFinished(&reader)) {
+      readDeltaEntry(&reader, &entry);
+      setBitSetBlock(bitSet, entry.blockPos,
+                     bitSet->bits[entry.blockPos] ^ entry.mask);
+    }
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode chainBitSetDeltas(const BitSetDelta *firstDelta,
+                                const BitSetDelta *secondDelta,
+                                BitSetDelta *resultDelta) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  DeltaReader firstReader;
+  DeltaReader secondReader;
+  uint64_t firstCapacity = 0;
+  uint64_t secondCapacity = 0;
+  size_t allocated = 0;
+  uint64_t nextBlockPos = 0;
+
+  resultDelta->data = NULL;
+  resultDelta->length = 0;
+
+  if (!openDelta(&firstReader, firstDelta, &firstCapacity) ||
+      !openDelta(&secondReader, secondDelta, &secondCapacity) ||
+      firstCapacity != secondCapacity) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    statusCode = beginDelta(resultDelta, &allocated, firstCapacity);
+  }
+
+  DeltaEntry firstEntry;
+  DeltaEntry secondEntry;
+  bool hasFirst = false;
+  bool hasSecond = false;
+  bool isFinished = false;
+
+  // Both deltas are sorted by block, so they are merged in one pass
+  while (!statusCode && !isFinished) {
+    if (!hasFirst && !isDeltaFinished(&firstReader)) {
+      hasFirst = readDeltaEntry(&firstReader, &firstEntry);
+      statusCode = hasFirst ? NONE_ERROR : INVALID_ARGUMENT_ERROR;
+    }
+    if (!hasSecond && !isDeltaFinished(&secondReader) && !statusCode) {
+      hasSecond = readDeltaEntry(&secondReader, &secondEntry);
+      statusCode = hasSecond ? NONE_ERROR : INVALID_ARGUMENT_ERROR;
+    }
+
+    isFinished = !hasFirst && !hasSecond;
+
+    if (!statusCode && !isFinished) {
+      DeltaEntry entry;
+      if (hasFirst &&
+          (!hasSecond || firstEntry.blockPos < secondEntry.blockPos)) {
+        entry = firstEntry;
+        hasFirst = false;
+      } else if (!hasFirst || secondEntry.blockPos < firstEntry.blockPos) {
+        entry = secondEntry;
+        hasSecond = false;
+      } else {
+        entry.blockPos = firstEntry.blockPos;
+        entry.mask = firstEntry.mask ^ secondEntry.mask;
+        hasFirst = false;
+        hasSecond = false;
+      }
+
+      if (entry.mask != 0) {
+        statusCode =
+            writeDeltaEntry(resultDelta, &allocated, &nextBlockPos, &entry);
+      }
+    }
+  }
+
+  if (statusCode) {
+    destroyBitSetDelta(resultDelta);
+  }
+
+  return statusCode;
+}
+
+void destroyBitSetDelta(BitSetDelta *delta) {
+  free(delta->data);
+  delta->data = NULL;
+  delta->length = 0;
+}
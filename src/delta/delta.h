@@ -0,0 +1,54 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+#define MIN_DELTA_SIZE 64
+
+/*
+  Encoded difference between two versions of a set. The data holds the
+  capacity followed by pairs of block index gap and XOR mask, all of
+  them as LEB128 varints. Masks are stored bit-reversed, so changes of
+  the low elements of a block, which sit in its high bits, stay short
+*/
+typedef struct BitSetDelta {
+  uint8_t *data;  // Encoded delta
+  size_t length;  // Number of used bytes
+} BitSetDelta;
+
+/*
+  Encodes the changed blocks between two sets of the same capacity
+*/
+BaseErrorCode createBitSetDelta(const BitSet *oldBitSet,
+                                const BitSet *newBitSet, BitSetDelta *delta);
+
+/*
+  Encodes the non-empty blocks of the set, which is the delta from the
+  empty set of the same capacity. No empty set is allocated for this
+*/
+BaseErrorCode createBitSetDeltaFromEmpty(const BitSet *bitSet,
+                                         BitSetDelta *delta);
+
+/*
+  Turns the old version of the set into the new one.
+  The set is not changed if the delta is malformed
+*/
+BaseErrorCode applyBitSetDelta(const BitSet *bitSet, const BitSetDelta *delta);
+
+/*
+  Combines two consecutive deltas into one which has the same effect
+*/
+BaseErrorCode chainBitSetDeltas(const BitSetDelta *firstDelta,
+                                const BitSetDelta *secondDelta,
+                                BitSetDelta *resultDelta);
+
+/*
+  Removes the delta data
+*/
+void destroyBitSetDelta(BitSetDelta *delta);
+
+#endif
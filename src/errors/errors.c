@@ -12,6 +12,24 @@ char *getBaseErrorMessage(const BaseErrorCode code) {
         case NEGATIVE_NUMBER_ERROR:
             message = "Error: working with negative numbers is impossible.";
             break;
+        case ELEMENT_NOT_FOUND_ERROR:
+            message = "Error: required element is not found.";
+            break;
+        case INVALID_ARGUMENT_ERROR:
+            message = "Error: invalid argument is passed.";
+            break;
+        case FILE_READ_ERROR:
+            message = "Error: reading from the file failed.";
+            break;
+        case FILE_WRITE_ERROR:
+            message = "Error: writing to the file failed.";
+            break;
+        case SHARED_MEMORY_ERROR:
+            message = "Error: shared memory segment is unavailable.";
+            break;
+        case SHARED_SNAPSHOT_ERROR:
+            message = "Error: shared set kept changing during the snapshot.";
+            break;
         default:
             message = "Error: unknown error.";
     }
@@ -66,6 +84,74 @@ char *getTestErrorMessage(const TestErrorCode code) {
             message = "ComplementTest failed. "
                       "Error: set is not a complement.";
             break;
+        case SUMMARY_TEST_ERROR:
+            message = "SummaryTest failed. "
+                      "Error: summary index does not match the set.";
+            break;
+        case FIND_TEST_ERROR:
+            message = "FindTest failed. "
+                      "Error: found element is incorrect.";
+            break;
+        case ALLOCATION_TEST_ERROR:
+            message = "AllocationTest failed. "
+                      "Error: allocated elements are incorrect.";
+            break;
+        case INGEST_TEST_ERROR:
+            message = "IngestTest failed. "
+                      "Error: ingested elements are incorrect.";
+            break;
+        case HASH_TEST_ERROR:
+            message = "HashTest failed. "
+                      "Error: hashes of sets are inconsistent.";
+            break;
+        case INTERN_TEST_ERROR:
+            message = "InternTest failed. "
+                      "Error: interned sets are not shared.";
+            break;
+        case DELTA_TEST_ERROR:
+            message = "DeltaTest failed. "
+                      "Error: applied delta does not restore the set.";
+            break;
+        case FIXED_BITSET_TEST_ERROR:
+            message = "FixedBitSetTest failed. "
+                      "Error: fixed set differs from the dynamic one.";
+            break;
+        case WINDOW_TEST_ERROR:
+            message = "WindowTest failed. "
+                      "Error: operation on windowed sets is incorrect.";
+            break;
+        case SHIFT_TEST_ERROR:
+            message = "ShiftTest failed. "
+                      "Error: elements are not moved correctly.";
+            break;
+        case BLOOM_FILTER_TEST_ERROR:
+            message = "BloomFilterTest failed. "
+                      "Error: filter lost a key or is too inaccurate.";
+            break;
+        case JOURNAL_TEST_ERROR:
+            message = "JournalTest failed. "
+                      "Error: recovered set differs from the journaled one.";
+            break;
+        case BULK_BUILD_TEST_ERROR:
+            message = "BulkBuildTest failed. "
+                      "Error: built set differs from the added elements.";
+            break;
+        case ACTIVE_RANGE_TEST_ERROR:
+            message = "ActiveRangeTest failed. "
+                      "Error: active range does not match the set.";
+            break;
+        case SHARED_BITSET_TEST_ERROR:
+            message = "SharedBitSetTest failed. "
+                      "Error: processes see different shared sets.";
+            break;
+        case ITERATOR_TEST_ERROR:
+            message = "IteratorTest failed. "
+                      "Error: iterated elements differ from the result set.";
+            break;
+        case ARRAY_OPERATION_TEST_ERROR:
+            message = "ArrayOperationTest failed. "
+                      "Error: array operation result is wrong.";
+            break;
         default:
             message = "Error: unknown error";
     }
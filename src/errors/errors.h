@@ -6,6 +6,12 @@ typedef enum {
   MEMORY_ALLOCATION_ERROR,
   CAPACITY_EXCEEDING_ERROR,
   NEGATIVE_NUMBER_ERROR,
+  ELEMENT_NOT_FOUND_ERROR,
+  INVALID_ARGUMENT_ERROR,
+  FILE_READ_ERROR,
+  FILE_WRITE_ERROR,
+  SHARED_MEMORY_ERROR,
+  SHARED_SNAPSHOT_ERROR,
 } BaseErrorCode;
 
 typedef enum {
@@ -20,6 +26,23 @@ typedef enum {
   DIFFERENCE_TEST_ERROR,
   SYMMETRIC_DIFFERENCE_TEST_ERROR,
   COMPLEMENT_TEST_ERROR,
+  SUMMARY_TEST_ERROR,
+  FIND_TEST_ERROR,
+  ALLOCATION_TEST_ERROR,
+  INGEST_TEST_ERROR,
+  HASH_TEST_ERROR,
+  INTERN_TEST_ERROR,
+  DELTA_TEST_ERROR,
+  FIXED_BITSET_TEST_ERROR,
+  WINDOW_TEST_ERROR,
+  SHIFT_TEST_ERROR,
+  BLOOM_FILTER_TEST_ERROR,
+  JOURNAL_TEST_ERROR,
+  BULK_BUILD_TEST_ERROR,
+  ACTIVE_RANGE_TEST_ERROR,
+  SHARED_BITSET_TEST_ERROR,
+  ITERATOR_TEST_ERROR,
+  ARRAY_OPERATION_TEST_ERROR,
 
 } TestErrorCode;
 
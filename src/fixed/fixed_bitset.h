@@ -0,0 +1,179 @@
+#ifndef FIXED_BITSET_H
+#define FIXED_BITSET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+#define FIXED_BITSET_BLOCKS(bitCount) \
+  (((bitCount) + BIT_PER_BLOCK - 1) / BIT_PER_BLOCK)
+
+/*
+  Mask of the last block bits which belong to [0, bitCount)
+*/
+#define FIXED_BITSET_LAST_MASK(bitCount)   \
+  ((bitCount) % BIT_PER_BLOCK == 0         \
+       ? ~0ULL                             \
+       : ~0ULL << (BIT_PER_BLOCK - (bitCount) % BIT_PER_BLOCK))
+
+/*
+  Defines a set type of numbers in [0, bitCount) stored inline, without
+  heap allocation, and its functions. The bit order is the same as in
+  BitSet, so the blocks are copied as is on conversion. Since the number
+  of blocks is a constant, the loops are unrolled by the compiler.
+
+  For DEFINE_FIXED_BITSET(FlagSet, 128) the type FlagSet and functions
+  such as addFlagSetElement and getFlagSetsUnion are generated
+*/
+#define DEFINE_FIXED_BITSET(name, bitCount)                                   \
+  typedef struct name {                                                       \
+    uint64_t bits[FIXED_BITSET_BLOCKS(bitCount)];                             \
+  } name;                                                                     \
+                                                                              \
+  static inline name create##name(void) {                                     \
+    const name bitSet = {{0}};                                                \
+    return bitSet;                                                            \
+  }                                                                           \
+                                                                              \
+  static inline BaseErrorCode add##name##Element(name *bitSet,                \
+                                                 const uint64_t element) {    \
+    BaseErrorCode statusCode = NONE_ERROR;                                    \
+    if (element >= (bitCount)) {                                              \
+      statusCode = CAPACITY_EXCEEDING_ERROR;                                  \
+    } else {                                                                  \
+      bitSet->bits[element / BIT_PER_BLOCK] |=                                \
+          1ULL << (BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1);              \
+    }                                                                         \
+    return statusCode;                                                        \
+  }                                                                           \
+                                                                              \
+  static inline BaseErrorCode remove##name##Element(name *bitSet,             \
+                                                    const uint64_t element) { \
+    BaseErrorCode statusCode = NONE_ERROR;                                    \
+    if (element >= (bitCount)) {                                              \
+      statusCode = CAPACITY_EXCEEDING_ERROR;                                  \
+    } else {                                                                  \
+      bitSet->bits[element / BIT_PER_BLOCK] &=                                \
+          ~(1ULL << (BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1));           \
+    }                                                                         \
+    return statusCode;                                                        \
+  }                                                                           \
+                                                                              \
+  static inline bool is##name##Contains(const name *bitSet,                   \
+                                        const uint64_t element) {             \
+    return element < (bitCount) &&                                            \
+           (bitSet->bits[element / BIT_PER_BLOCK] >>                          \
+                (BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1) &               \
+            1);                                                               \
+  }                                                                           \
+                                                                              \
+  static inline bool is##name##Empty(const name *bitSet) {                    \
+    uint64_t combined = 0;                                                    \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      combined |= bitSet->bits[iter];                                         \
+    }                                                                         \
+    return combined == 0;                                                     \
+  }                                                                           \
+                                                                              \
+  static inline bool is##name##sEqual(const name *bitSetA,                    \
+                                      const name *bitSetB) {                  \
+    uint64_t difference = 0;                                                  \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      difference |= bitSetA->bits[iter] ^ bitSetB->bits[iter];                \
+    }                                                                         \
+    return difference == 0;                                                   \
+  }                                                                           \
+                                                                              \
+  static inline bool is##name##Subset(const name *bitSetA,                    \
+                                      const name *bitSetB) {                  \
+    uint64_t excess = 0;                                                      \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      excess |= bitSetA->bits[iter] & ~bitSetB->bits[iter];                   \
+    }                                                                         \
+    return excess == 0;                                                       \
+  }                                                                           \
+                                                                              \
+  static inline name get##name##sUnion(const name *bitSetA,                   \
+                                       const name *bitSetB) {                 \
+    name resultBitSet;                                                        \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      resultBitSet.bits[iter] = bitSetA->bits[iter] | bitSetB->bits[iter];    \
+    }                                                                         \
+    return resultBitSet;                                                      \
+  }                                                                           \
+                                                                              \
+  static inline name get##name##sIntersection(const name *bitSetA,            \
+                                              const name *bitSetB) {          \
+    name resultBitSet;                                                        \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      resultBitSet.bits[iter] = bitSetA->bits[iter] & bitSetB->bits[iter];    \
+    }                                                                         \
+    return resultBitSet;                                                      \
+  }                                                                           \
+                                                                              \
+  static inline name get##name##sDiff(const name *bitSetA,                    \
+                                      const name *bitSetB) {                  \
+    name resultBitSet;                                                        \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      resultBitSet.bits[iter] = bitSetA->bits[iter] & ~bitSetB->bits[iter];   \
+    }                                                                         \
+    return resultBitSet;                                                      \
+  }                                                                           \
+                                                                              \
+  static inline name getSymmetric##name##sDiff(const name *bitSetA,           \
+                                               const name *bitSetB) {         \
+    name resultBitSet;                                                        \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      resultBitSet.bits[iter] = bitSetA->bits[iter] ^ bitSetB->bits[iter];    \
+    }                                                                         \
+    return resultBitSet;                                                      \
+  }                                                                           \
+                                                                              \
+  static inline name get##name##Complement(const name *bitSet) {              \
+    name resultBitSet;                                                        \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      resultBitSet.bits[iter] = ~bitSet->bits[iter];                          \
+    }                                                                         \
+    resultBitSet.bits[FIXED_BITSET_BLOCKS(bitCount) - 1] &=                   \
+        FIXED_BITSET_LAST_MASK(bitCount);                                     \
+    return resultBitSet;                                                      \
+  }                                                                           \
+                                                                              \
+  /* Creates a BitSet with capacity bitCount - 1 and the same elements */     \
+  static inline BitSet get##name##AsBitSet(const name *bitSet) {              \
+    BitSet resultBitSet = createBitSet((bitCount) - 1);                       \
+    if (resultBitSet.bits != NULL) {                                          \
+      memcpy(resultBitSet.bits, bitSet->bits, sizeof(bitSet->bits));          \
+    }                                                                         \
+    return resultBitSet;                                                      \
+  }                                                                           \
+                                                                              \
+  /* Elements of the BitSet beyond bitCount are skipped with an error */      \
+  static inline BaseErrorCode set##name##FromBitSet(name *bitSet,             \
+                                                    const BitSet *source) {   \
+    BaseErrorCode statusCode = NONE_ERROR;                                    \
+    for (size_t iter = 0; iter < FIXED_BITSET_BLOCKS(bitCount); iter++) {     \
+      bitSet->bits[iter] = iter < source->size ? source->bits[iter] : 0;      \
+    }                                                                         \
+    const size_t lastPos = FIXED_BITSET_BLOCKS(bitCount) - 1;                 \
+    if ((bitSet->bits[lastPos] & ~FIXED_BITSET_LAST_MASK(bitCount)) != 0) {   \
+      bitSet->bits[lastPos] &= FIXED_BITSET_LAST_MASK(bitCount);              \
+      statusCode = CAPACITY_EXCEEDING_ERROR;                                  \
+    }                                                                         \
+    for (size_t iter = FIXED_BITSET_BLOCKS(bitCount); iter < source->size;    \
+         iter++) {                                                            \
+      if (source->bits[iter] != 0) {                                          \
+        statusCode = CAPACITY_EXCEEDING_ERROR;                                \
+      }                                                                       \
+    }                                                                         \
+    return statusCode;                                                        \
+  }
+
+DEFINE_FIXED_BITSET(BitSet64, 64)
+DEFINE_FIXED_BITSET(BitSet128, 128)
+DEFINE_FIXED_BITSET(BitSet256, 256)
+
+#endif
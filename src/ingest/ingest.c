@@ -0,0 +1,532 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ingest.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <threads.h>
+#include <unistd.h>
+
+typedef struct IngestTask {
+  const char *buffer;  // Part of the text handled by the task
+  size_t length;       // Length of the part
+  uint64_t *elements;  // Valid numbers of the part
+  size_t count;        // Number of valid numbers
+  size_t allocated;    // Number of numbers the array can hold
+  bool isFailed;       // The array could not grow
+  IngestStats stats;
+} IngestTask;
+
+typedef struct BuildTask {
+  const BitSet *bitSet;
+  const uint64_t *elements;  // Part of the input handled by the task
+  size_t count;              // Number of elements in the part
+  size_t *partitionCounts;   // Elements of the part per partition
+  size_t *partitionOffsets;  // Scatter positions of the part per partition
+  uint64_t *partitioned;     // Elements grouped by partition
+  size_t partitionBegin;     // First element of the filled partition
+  size_t partitionEnd;       // Element after the filled partition
+  size_t partitionCount;     // Number of partitions
+  size_t partitionBlocks;    // Number of blocks per partition
+  IngestStats stats;
+} BuildTask;
+
+static bool isSeparator(const char symbol) {
+  return symbol == ',' || symbol == '\n' || symbol == '\r' || symbol == ' ' ||
+         symbol == '\t';
+}
+
+static void countElement(const BitSet *bitSet, const bool isValid,
+                         const uint64_t element, IngestStats *stats) {
+  if (isValid && addBitSetElement(bitSet, element) == NONE_ERROR) {
+    stats->accepted++;
+  } else {
+    stats->rejected++;
+  }
+}
+
+/*
+  Reads the next token of the buffer. A token is valid if it consists of
+  decimal digits only and fits into uint64_t. Returns false at the end
+*/
+static bool readToken(const char *buffer, const size_t length,
+                      size_t *position, uint64_t *number, bool *isValid) {
+  while (*position < length && isSeparator(buffer[*position])) {
+    (*position)++;
+  }
+
+  *number = 0;
+  *isValid = true;
+  const bool isFound = *position < length;
+
+  while (*position < length && !isSeparator(buffer[*position])) {
+    const uint64_t digit = (uint64_t)(unsigned char)buffer[*position] - '0';
+    if (digit > 9 || *number > (UINT64_MAX - digit) / 10) {
+      *isValid = false;
+    } else {
+      *number = *number * 10 + digit;
+    }
+    (*position)++;
+  }
+
+  return isFound;
+}
+
+static void parseText(const BitSet *bitSet, const char *buffer,
+                      const size_t length, IngestStats *stats) {
+  size_t position = 0;
+  uint64_t number = 0;
+  bool isValid = true;
+
+  while (readToken(buffer, length, &position, &number, &isValid)) {
+    countElement(bitSet, isValid, number, stats);
+  }
+}
+
+static uint64_t readLittleEndian(const uint8_t *bytes) {
+  uint64_t value = 0;
+  for (size_t iter = 0; iter < sizeof(uint64_t); iter++) {
+    value |= (uint64_t)bytes[iter] << (8 * iter);
+  }
+
+  return value;
+}
+
+static void parseBinary(const BitSet *bitSet, const uint8_t *buffer,
+                        const size_t length, IngestStats *stats) {
+  const size_t count = length / sizeof(uint64_t);
+
+  for (size_t iter = 0; iter < count; iter++) {
+    countElement(bitSet, true, readLittleEndian(buffer + iter * sizeof(uint64_t)),
+                 stats);
+  }
+}
+
+/*
+  Reads into the buffer until it has data or the file ends.
+  Interrupted reads are repeated
+*/
+static BaseErrorCode readChunk(const int fd, uint8_t *buffer,
+                               const size_t length, size_t *bytesRead) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  ssize_t result = -1;
+
+  do {
+    result = read(fd, buffer, length);
+  } while (result < 0 && errno == EINTR);
+
+  if (result < 0) {
+    statusCode = FILE_READ_ERROR;
+    *bytesRead = 0;
+  } else {
+    *bytesRead = (size_t)result;
+  }
+
+  return statusCode;
+}
+
+static void resetStats(IngestStats *stats) {
+  stats->accepted = 0;
+  stats->rejected = 0;
+}
+
+BaseErrorCode ingestBitSetFromText(const BitSet *bitSet, const char *buffer,
+                                   const size_t length, IngestStats *stats) {
+  resetStats(stats);
+  parseText(bitSet, buffer, length, stats);
+
+  return NONE_ERROR;
+}
+
+/*
+  Runs the function for every task on its own thread. Tasks whose thread
+  cannot be started are run on the calling thread
+*/
+static void runTasks(void *tasks, const size_t taskSize, const size_t taskCount,
+                     const thrd_start_t function) {
+  thrd_t *threads = calloc(taskCount, sizeof(thrd_t));
+  bool *isStarted = calloc(taskCount, sizeof(bool));
+
+  for (size_t iter = 0; iter < taskCount; iter++) {
+    void *task = (char *)tasks + iter * taskSize;
+    if (threads != NULL && isStarted != NULL) {
+      isStarted[iter] =
+          thrd_create(&threads[iter], function, task) == thrd_success;
+    }
+    if (isStarted == NULL || !isStarted[iter]) {
+      function(task);
+    }
+  }
+
+  for (size_t iter = 0; iter < taskCount && isStarted != NULL; iter++) {
+    if (isStarted[iter]) {
+      thrd_join(threads[iter], NULL);
+    }
+  }
+
+  free(threads);
+  free(isStarted);
+}
+
+static size_t getPartition(const BuildTask *task, const uint64_t element) {
+  return element / BIT_PER_BLOCK / task->partitionBlocks;
+}
+
+static bool isElementValid(const BuildTask *task, const uint64_t element) {
+  return element <= (uint64_t)task->bitSet->capacity;
+}
+
+static int countPartitions(void *argument) {
+  BuildTask *task = argument;
+
+  for (size_t iter = 0; iter < task->count; iter++) {
+    const uint64_t element = task->elements[iter];
+    if (isElementValid(task, element)) {
+      task->partitionCounts[getPartition(task, element)]++;
+    } else {
+      task->stats.rejected++;
+    }
+  }
+
+  return 0;
+}
+
+static int scatterElements(void *argument) {
+  BuildTask *task = argument;
+
+  for (size_t iter = 0; iter < task->count; iter++) {
+    const uint64_t element = task->elements[iter];
+    if (isElementValid(task, element)) {
+      task->partitioned[task->partitionOffsets[getPartition(task, element)]++] =
+          element;
+    }
+  }
+
+  return 0;
+}
+
+/*
+  Sets the bits of the partition directly. The elements are already
+  checked, and the blocks and summary words belong to this task only,
+  so there are no atomics. The active range is extended once at the end
+*/
+static int fillPartition(void *argument) {
+  BuildTask *task = argument;
+  const BitSet *bitSet = task->bitSet;
+  size_t firstBlock = SIZE_MAX;
+  size_t lastBlock = 0;
+
+  for (size_t iter = task->partitionBegin; iter < task->partitionEnd; iter++) {
+    const uint64_t element = task->partitioned[iter];
+    const size_t blockPos = element / BIT_PER_BLOCK;
+    const uint64_t block = bitSet->bits[blockPos];
+
+    bitSet->bits[blockPos] =
+        block | 1ULL << (BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1);
+
+    // Only the first element of an empty block changes the summary
+    if (block == 0) {
+      if (bitSet->summary != NULL) {
+        bitSet->summary[blockPos / BIT_PER_BLOCK] |=
+            1ULL << (BIT_PER_BLOCK - blockPos % BIT_PER_BLOCK - 1);
+      }
+      firstBlock = blockPos < firstBlock ? blockPos : firstBlock;
+      lastBlock = blockPos > lastBlock ? blockPos : lastBlock;
+    }
+  }
+
+  // Rewriting the outermost new blocks extends the range over all of them
+  if (firstBlock <= lastBlock) {
+    setBitSetBlock(bitSet, firstBlock, bitSet->bits[firstBlock]);
+    setBitSetBlock(bitSet, lastBlock, bitSet->bits[lastBlock]);
+  }
+  task->stats.accepted += task->partitionEnd - task->partitionBegin;
+
+  return 0;
+}
+
+BaseErrorCode buildBitSetFromElements(const BitSet *bitSet, const size_t count,
+                                      const uint64_t elements[],
+                                      const size_t threadCount,
+                                      IngestStats *stats) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  const size_t taskCount = threadCount > 0 ? threadCount : 1;
+  resetStats(stats);
+
+  // Partitions are whole summary words, so no two threads share a word
+  size_t partitionBlocks = (bitSet->size + taskCount - 1) / taskCount;
+  partitionBlocks =
+      (partitionBlocks + BIT_PER_BLOCK - 1) / BIT_PER_BLOCK * BIT_PER_BLOCK;
+  const size_t partitionCount =
+      (bitSet->size + partitionBlocks - 1) / partitionBlocks;
+
+  BuildTask *tasks = calloc(taskCount, sizeof(BuildTask));
+  size_t *partitionCounts = calloc(taskCount * partitionCount, sizeof(size_t));
+  size_t *partitionOffsets = calloc(taskCount * partitionCount, sizeof(size_t));
+  uint64_t *partitioned = malloc((count > 0 ? count : 1) * sizeof(uint64_t));
+
+  if (tasks == NULL || partitionCounts == NULL || partitionOffsets == NULL ||
+      partitioned == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  }
+
+  for (size_t iter = 0; iter < taskCount && !statusCode; iter++) {
+    const size_t begin = count / taskCount * iter;
+    const size_t end = iter + 1 == taskCount ? count
+                                             : count / taskCount * (iter + 1);
+
+    tasks[iter].bitSet = bitSet;
+    tasks[iter].elements = elements + begin;
+    tasks[iter].count = end - begin;
+    tasks[iter].partitionCounts = partitionCounts + iter * partitionCount;
+    tasks[iter].partitionOffsets = partitionOffsets + iter * partitionCount;
+    tasks[iter].partitioned = partitioned;
+    tasks[iter].partitionCount = partitionCount;
+    tasks[iter].partitionBlocks = partitionBlocks;
+  }
+
+  if (!statusCode) {
+    runTasks(tasks, sizeof(BuildTask), taskCount, countPartitions);
+
+    // Partition by partition, the parts of the input follow each other
+    size_t offset = 0;
+    for (size_t partition = 0; partition < partitionCount; partition++) {
+      if (partition < taskCount) {
+        tasks[partition].partitionBegin = offset;
+      }
+      for (size_t iter = 0; iter < taskCount; iter++) {
+        tasks[iter].partitionOffsets[partition] = offset;
+        offset += tasks[iter].partitionCounts[partition];
+      }
+      if (partition < taskCount) {
+        tasks[partition].partitionEnd = offset;
+      }
+    }
+
+    runTasks(tasks, sizeof(BuildTask), taskCount, scatterElements);
+    runTasks(tasks, sizeof(BuildTask), taskCount, fillPartition);
+
+    for (size_t iter = 0; iter < taskCount; iter++) {
+      stats->accepted += tasks[iter].stats.accepted;
+      stats->rejected += tasks[iter].stats.rejected;
+    }
+  }
+
+  free(tasks);
+  free(partitionCounts);
+  free(partitionOffsets);
+  free(partitioned);
+
+  return statusCode;
+}
+
+/*
+  Collects the valid numbers of the task's part. Malformed tokens are
+  counted as rejected, the capacity is checked later by the build
+*/
+static int runIngestTask(void *argument) {
+  IngestTask *task = argument;
+  size_t position = 0;
+  uint64_t number = 0;
+  bool isValid = true;
+
+  while (!task->isFailed &&
+         readToken(task->buffer, task->length, &position, &number, &isValid)) {
+    if (!isValid) {
+      task->stats.rejected++;
+    } else {
+      if (task->count == task->allocated) {
+        const size_t allocated = task->allocated > 0 ? task->allocated * 2 : 64;
+        uint64_t *elements =
+            realloc(task->elements, allocated * sizeof(uint64_t));
+
+        task->isFailed = elements == NULL;
+        if (!task->isFailed) {
+          task->elements = elements;
+          task->allocated = allocated;
+        }
+      }
+      if (!task->isFailed) {
+        task->elements[task->count++] = number;
+      }
+    }
+  }
+
+  return 0;
+}
+
+BaseErrorCode ingestBitSetFromTextParallel(const BitSet *bitSet,
+                                           const char *buffer,
+                                           const size_t length,
+                                           const size_t threadCount,
+                                           IngestStats *stats) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  resetStats(stats);
+
+  if (threadCount <= 1) {
+    parseText(bitSet, buffer, length, stats);
+  } else {
+    IngestTask *tasks = calloc(threadCount, sizeof(IngestTask));
+    if (tasks == NULL) {
+      statusCode = MEMORY_ALLOCATION_ERROR;
+    }
+
+    size_t begin = 0;
+    for (size_t iter = 0; iter < threadCount && !statusCode; iter++) {
+      // Each part ends on a separator so no number is split between threads
+      size_t end = iter + 1 == threadCount ? length
+                                           : length / threadCount * (iter + 1);
+      end = end > begin ? end : begin;
+      while (end < length && !isSeparator(buffer[end])) {
+        end++;
+      }
+
+      tasks[iter].buffer = buffer + begin;
+      tasks[iter].length = end - begin;
+      begin = end;
+    }
+
+    size_t count = 0;
+    if (!statusCode) {
+      runTasks(tasks, sizeof(IngestTask), threadCount, runIngestTask);
+
+      for (size_t iter = 0; iter < threadCount; iter++) {
+        count += tasks[iter].count;
+        if (tasks[iter].isFailed) {
+          statusCode = MEMORY_ALLOCATION_ERROR;
+        }
+      }
+    }
+
+    // The parts are joined and built by block ranges, so every thread
+    // writes its own blocks of the set instead of a partial copy
+    uint64_t *elements = NULL;
+    if (!statusCode) {
+      elements = malloc((count > 0 ? count : 1) * sizeof(uint64_t));
+      statusCode = elements == NULL ? MEMORY_ALLOCATION_ERROR : NONE_ERROR;
+    }
+
+    if (!statusCode) {
+      size_t offset = 0;
+      for (size_t iter = 0; iter < threadCount; iter++) {
+        memcpy(elements + offset, tasks[iter].elements,
+               tasks[iter].count * sizeof(uint64_t));
+        offset += tasks[iter].count;
+        stats->rejected += tasks[iter].stats.rejected;
+      }
+
+      IngestStats buildStats;
+      statusCode = buildBitSetFromElements(bitSet, count, elements,
+                                           threadCount, &buildStats);
+      stats->accepted += buildStats.accepted;
+      stats->rejected += buildStats.rejected;
+    }
+
+    for (size_t iter = 0; iter < threadCount && tasks != NULL; iter++) {
+      free(tasks[iter].elements);
+    }
+    free(tasks);
+    free(elements);
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode ingestBitSetFromTextFile(const BitSet *bitSet, const int fd,
+                                       IngestStats *stats) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  resetStats(stats);
+
+  char *buffer = malloc(INGEST_CHUNK_SIZE);
+  if (buffer == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  }
+
+  size_t carry = 0;
+  size_t bytesRead = 1;
+  bool isSkippingToken = false;
+
+  while (!statusCode && bytesRead > 0) {
+    statusCode = readChunk(fd, (uint8_t *)buffer + carry,
+                           INGEST_CHUNK_SIZE - carry, &bytesRead);
+    size_t filled = carry + bytesRead;
+    size_t begin = 0;
+
+    // The rest of a token longer than the chunk is already rejected
+    while (isSkippingToken && begin < filled) {
+      isSkippingToken = !isSeparator(buffer[begin]);
+      begin += isSkippingToken;
+    }
+
+    // Only the complete tokens are parsed, the tail waits for the next chunk
+    size_t parsedEnd = filled;
+    if (bytesRead > 0) {
+      while (parsedEnd > begin && !isSeparator(buffer[parsedEnd - 1])) {
+        parsedEnd--;
+      }
+    }
+
+    if (parsedEnd == begin && filled - begin == INGEST_CHUNK_SIZE) {
+      stats->rejected++;
+      isSkippingToken = true;
+      carry = 0;
+    } else if (!statusCode) {
+      parseText(bitSet, buffer + begin, parsedEnd - begin, stats);
+      carry = filled - parsedEnd;
+      memmove(buffer, buffer + parsedEnd, carry);
+    }
+  }
+
+  free(buffer);
+
+  return statusCode;
+}
+
+BaseErrorCode ingestBitSetFromBinary(const BitSet *bitSet,
+                                     const uint8_t *buffer,
+                                     const size_t length, IngestStats *stats) {
+  resetStats(stats);
+  parseBinary(bitSet, buffer, length, stats);
+
+  if (length % sizeof(uint64_t) != 0) {
+    stats->rejected++;
+  }
+
+  return NONE_ERROR;
+}
+
+BaseErrorCode ingestBitSetFromBinaryFile(const BitSet *bitSet, const int fd,
+                                         IngestStats *stats) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  resetStats(stats);
+
+  uint8_t *buffer = malloc(INGEST_CHUNK_SIZE);
+  if (buffer == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  }
+
+  size_t carry = 0;
+  size_t bytesRead = 1;
+
+  while (!statusCode && bytesRead > 0) {
+    statusCode = readChunk(fd, buffer + carry, INGEST_CHUNK_SIZE - carry,
+                           &bytesRead);
+    const size_t filled = carry + bytesRead;
+    const size_t parsedEnd = filled - filled % sizeof(uint64_t);
+
+    if (!statusCode) {
+      parseBinary(bitSet, buffer, parsedEnd, stats);
+      carry = filled - parsedEnd;
+      memmove(buffer, buffer + parsedEnd, carry);
+    }
+  }
+
+  if (!statusCode && carry > 0) {
+    stats->rejected++;
+  }
+
+  free(buffer);
+
+  return statusCode;
+}
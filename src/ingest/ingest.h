@@ -0,0 +1,67 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+#define INGEST_CHUNK_SIZE (1 << 20)
+
+typedef struct IngestStats {
+  size_t accepted;  // Number of elements added to the set
+  size_t rejected;  // Number of malformed or out of capacity elements
+} IngestStats;
+
+/*
+  Adds the numbers from a text buffer to the set. Numbers are separated
+  by commas, spaces or line breaks. Invalid tokens are counted and skipped
+*/
+BaseErrorCode ingestBitSetFromText(const BitSet *bitSet, const char *buffer,
+                                   size_t length, IngestStats *stats);
+
+/*
+  Same as ingestBitSetFromText, but the buffer is split between threadCount
+  threads, each collecting the numbers of its part. The numbers are then
+  added with buildBitSetFromElements, so the threads write disjoint blocks
+  of the set. Extra memory is one uint64_t per valid number
+*/
+BaseErrorCode ingestBitSetFromTextParallel(const BitSet *bitSet,
+                                           const char *buffer, size_t length,
+                                           size_t threadCount,
+                                           IngestStats *stats);
+
+/*
+  Reads the text from the file descriptor in chunks and adds the numbers
+  to the set. Parsing runs on the calling thread; to parse in parallel,
+  read the text into memory and use ingestBitSetFromTextParallel
+*/
+BaseErrorCode ingestBitSetFromTextFile(const BitSet *bitSet, int fd,
+                                       IngestStats *stats);
+
+/*
+  Adds the little-endian uint64 values from a binary buffer to the set.
+  A trailing incomplete value is counted as rejected
+*/
+BaseErrorCode ingestBitSetFromBinary(const BitSet *bitSet,
+                                     const uint8_t *buffer, size_t length,
+                                     IngestStats *stats);
+
+/*
+  Reads little-endian uint64 values from the file descriptor in chunks
+  and adds them to the set
+*/
+BaseErrorCode ingestBitSetFromBinaryFile(const BitSet *bitSet, int fd,
+                                         IngestStats *stats);
+
+/*
+  Adds the elements of an unsorted array to the set using threadCount
+  threads. The elements are partitioned by block ranges first, so every
+  thread fills its own blocks and summary words without atomics
+*/
+BaseErrorCode buildBitSetFromElements(const BitSet *bitSet, size_t count,
+                                      const uint64_t elements[],
+                                      size_t threadCount, IngestStats *stats);
+
+#endif
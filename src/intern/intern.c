@@ -0,0 +1,147 @@
+#include "intern.h"
+
+BitSetInternTable createBitSetInternTable(void) {
+  BitSetInternTable table;
+
+  table.bucketCount = MIN_INTERN_BUCKETS;
+  table.count = 0;
+  table.buckets = (InternNode **)calloc(table.bucketCount, sizeof(InternNode *));
+
+  if (table.buckets == NULL) {
+    table.bucketCount = 0;
+  }
+
+  return table;
+}
+
+void destroyBitSetInternTable(BitSetInternTable *table) {
+  for (size_t bucket = 0; bucket < table->bucketCount; bucket++) {
+    InternNode *node = table->buckets[bucket];
+    while (node != NULL) {
+      InternNode *next = node->next;
+      destroyBitSet(&node->bitSet);
+      free(node);
+      node = next;
+    }
+  }
+
+  free(table->buckets);
+  table->buckets = NULL;
+  table->bucketCount = 0;
+  table->count = 0;
+}
+
+/*
+  Doubles the number of buckets. Nodes are relinked, so the canonical
+  sets keep their addresses
+*/
+static BaseErrorCode growInternTable(BitSetInternTable *table) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  const size_t bucketCount = table->bucketCount * 2;
+
+  InternNode **buckets = (InternNode **)calloc(bucketCount, sizeof(InternNode *));
+  if (buckets == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  } else {
+    for (size_t bucket = 0; bucket < table->bucketCount; bucket++) {
+      InternNode *node = table->buckets[bucket];
+      while (node != NULL) {
+        InternNode *next = node->next;
+        node->next = buckets[node->hash % bucketCount];
+        buckets[node->hash % bucketCount] = node;
+        node = next;
+      }
+    }
+
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucketCount = bucketCount;
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode internBitSet(BitSetInternTable *table, const BitSet *bitSet,
+                           const BitSet **canonical) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  const uint64_t hash = getBitSetHash(bitSet);
+  InternNode *node = NULL;
+
+  // The buckets are NULL if the table could not be created
+  if (table->buckets == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  } else {
+    node = table->buckets[hash % table->bucketCount];
+    while (node != NULL &&
+           (node->hash != hash || !isBitSetsEqual(&node->bitSet, bitSet))) {
+      node = node->next;
+    }
+  }
+
+  if (!statusCode && node == NULL) {
+    if (table->count >= table->bucketCount) {
+      statusCode = growInternTable(table);
+    }
+
+    if (!statusCode) {
+      node = (InternNode *)malloc(sizeof(InternNode));
+      if (node == NULL) {
+        statusCode = MEMORY_ALLOCATION_ERROR;
+      }
+    }
+
+    if (!statusCode) {
+      node->bitSet = copyBitSet(bitSet);
+      if (node->bitSet.bits == NULL) {
+        free(node);
+        node = NULL;
+        statusCode = MEMORY_ALLOCATION_ERROR;
+      }
+    }
+
+    if (!statusCode) {
+      node->hash = hash;
+      node->references = 0;
+      node->next = table->buckets[hash % table->bucketCount];
+      table->buckets[hash % table->bucketCount] = node;
+      table->count++;
+    }
+  }
+
+  if (!statusCode) {
+    node->references++;
+    *canonical = &node->bitSet;
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode releaseInternedBitSet(BitSetInternTable *table,
+                                    const BitSet *canonical) {
+  BaseErrorCode statusCode = ELEMENT_NOT_FOUND_ERROR;
+  const uint64_t hash = getBitSetHash(canonical);
+  InternNode **link = NULL;
+
+  if (table->buckets == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  } else {
+    link = &table->buckets[hash % table->bucketCount];
+    while (*link != NULL && &(*link)->bitSet != canonical) {
+      link = &(*link)->next;
+    }
+  }
+
+  if (link != NULL && *link != NULL) {
+    InternNode *node = *link;
+    statusCode = NONE_ERROR;
+
+    if (--node->references == 0) {
+      *link = node->next;
+      destroyBitSet(&node->bitSet);
+      free(node);
+      table->count--;
+    }
+  }
+
+  return statusCode;
+}
@@ -0,0 +1,52 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+#define MIN_INTERN_BUCKETS 16
+
+typedef struct InternNode {
+  BitSet bitSet;            // Canonical copy of the set
+  uint64_t hash;            // Hash of the set contents
+  size_t references;        // Number of interned sets sharing this copy
+  struct InternNode *next;  // Next node in the same bucket
+} InternNode;
+
+typedef struct BitSetInternTable {
+  InternNode **buckets;  // Chains of nodes with the same bucket index
+  size_t bucketCount;    // Number of buckets
+  size_t count;          // Number of distinct sets
+} BitSetInternTable;
+
+/*
+  Creates an empty intern table.
+  In case of error, buckets are NULL
+*/
+BitSetInternTable createBitSetInternTable(void);
+
+/*
+  Removes the table together with all canonical sets
+*/
+void destroyBitSetInternTable(BitSetInternTable *table);
+
+/*
+  Finds the canonical set equal to the given one or stores a copy of it.
+  The canonical set is shared and must not be modified.
+  A table without buckets gives MEMORY_ALLOCATION_ERROR
+*/
+BaseErrorCode internBitSet(BitSetInternTable *table, const BitSet *bitSet,
+                           const BitSet **canonical);
+
+/*
+  Drops one reference to the canonical set and removes it from the table
+  when no references are left. A table without buckets gives
+  MEMORY_ALLOCATION_ERROR
+*/
+BaseErrorCode releaseInternedBitSet(BitSetInternTable *table,
+                                    const BitSet *canonical);
+
+#endif
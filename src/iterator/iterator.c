@@ -0,0 +1,220 @@
+#include "iterator.h"
+
+static size_t getBlockCount(const BitSet *bitSet) {
+  return bitSet != NULL ? bitSet->size : 0;
+}
+
+static uint64_t readBlock(const BitSet *bitSet, const size_t blockPos) {
+  return blockPos < getBlockCount(bitSet) ? bitSet->bits[blockPos] : 0;
+}
+
+static uint64_t readSummaryWord(const BitSet *bitSet, const size_t wordPos) {
+  return bitSet != NULL ? getBitSetSummaryWord(bitSet, wordPos) : 0;
+}
+
+/*
+  Returns the first block which can be non-empty according to the active
+  range. An empty range starts after the last block, a missing set never
+*/
+static size_t getStartBlock(const BitSet *bitSet) {
+  size_t startBlock = bitSet != NULL ? 0 : SIZE_MAX;
+
+  if (bitSet != NULL && bitSet->activeRange != NULL) {
+    const size_t firstBlock =
+        __atomic_load_n(&bitSet->activeRange->firstBlock, __ATOMIC_RELAXED);
+    const size_t lastBlock =
+        __atomic_load_n(&bitSet->activeRange->lastBlock, __ATOMIC_RELAXED);
+    startBlock = firstBlock <= lastBlock ? firstBlock : bitSet->size;
+  }
+
+  return startBlock;
+}
+
+/*
+  Removes the smallest element, which is the most significant bit
+*/
+static uint64_t clearFirstElement(const uint64_t block) {
+  return block & ~(1ULL << (BIT_PER_BLOCK - __builtin_clzll(block) - 1));
+}
+
+static BitSetIterator createIterator(const BitSet *bitSetA,
+                                     const BitSet *bitSetB,
+                                     const IteratorOperation operation) {
+  BitSetIterator iterator;
+  const size_t sizeA = getBlockCount(bitSetA);
+  const size_t sizeB = getBlockCount(bitSetB);
+  const size_t startInA = getStartBlock(bitSetA);
+  const size_t startInB = getStartBlock(bitSetB);
+  size_t startBlock;
+
+  iterator.bitSetA = bitSetA;
+  iterator.bitSetB = bitSetB;
+  iterator.operation = operation;
+  iterator.candidates = 0;
+  iterator.blockPos = 0;
+  iterator.block = 0;
+  iterator.remaining = SIZE_MAX;
+
+  switch (operation) {
+    case ITERATE_INTERSECTION:
+      iterator.endBlock = sizeA < sizeB ? sizeA : sizeB;
+      startBlock = startInA > startInB ? startInA : startInB;
+      break;
+    case ITERATE_DIFFERENCE:
+      iterator.endBlock = sizeA;
+      startBlock = startInA;
+      break;
+    default:
+      iterator.endBlock = sizeA > sizeB ? sizeA : sizeB;
+      startBlock = startInA < startInB ? startInA : startInB;
+  }
+
+  // The summary words before the active ranges are all zero
+  iterator.wordPos = startBlock < iterator.endBlock
+                         ? startBlock / BIT_PER_BLOCK
+                         : (iterator.endBlock + BIT_PER_BLOCK - 1) /
+                               BIT_PER_BLOCK;
+
+  return iterator;
+}
+
+BitSetIterator createBitSetIterator(const BitSet *bitSet) {
+  return createIterator(bitSet, NULL, ITERATE_UNION);
+}
+
+BitSetIterator createBitSetsUnionIterator(const BitSet *bitSetA,
+                                          const BitSet *bitSetB) {
+  return createIterator(bitSetA, bitSetB, ITERATE_UNION);
+}
+
+BitSetIterator createBitSetsIntersectionIterator(const BitSet *bitSetA,
+                                                 const BitSet *bitSetB) {
+  return createIterator(bitSetA, bitSetB, ITERATE_INTERSECTION);
+}
+
+BitSetIterator createBitSetsDiffIterator(const BitSet *bitSetA,
+                                         const BitSet *bitSetB) {
+  return createIterator(bitSetA, bitSetB, ITERATE_DIFFERENCE);
+}
+
+BitSetIterator createSymmetricBitSetsDiffIterator(const BitSet *bitSetA,
+                                                  const BitSet *bitSetB) {
+  return createIterator(bitSetA, bitSetB, ITERATE_SYMMETRIC_DIFFERENCE);
+}
+
+/*
+  Returns the blocks of the summary word which can be non-empty in the
+  result according to the summaries of the operands
+*/
+static uint64_t combineSummaryWords(const BitSetIterator *iterator,
+                                    const size_t wordPos) {
+  const uint64_t summaryInA = readSummaryWord(iterator->bitSetA, wordPos);
+  const uint64_t summaryInB = readSummaryWord(iterator->bitSetB, wordPos);
+  uint64_t candidates;
+
+  switch (iterator->operation) {
+    case ITERATE_INTERSECTION:
+      candidates = summaryInA & summaryInB;
+      break;
+    case ITERATE_DIFFERENCE:
+      candidates = summaryInA;
+      break;
+    default:
+      candidates = summaryInA | summaryInB;
+  }
+
+  return candidates;
+}
+
+static uint64_t combineBlocks(const BitSetIterator *iterator,
+                              const size_t blockPos) {
+  const uint64_t blockInA = readBlock(iterator->bitSetA, blockPos);
+  const uint64_t blockInB = readBlock(iterator->bitSetB, blockPos);
+  uint64_t resultBlock;
+
+  switch (iterator->operation) {
+    case ITERATE_UNION:
+      resultBlock = blockInA | blockInB;
+      break;
+    case ITERATE_INTERSECTION:
+      resultBlock = blockInA & blockInB;
+      break;
+    case ITERATE_DIFFERENCE:
+      resultBlock = blockInA & ~blockInB;
+      break;
+    default:
+      resultBlock = blockInA ^ blockInB;
+  }
+
+  return resultBlock;
+}
+
+/*
+  Moves to the next non-empty result block if the current one is used up.
+  Blocks empty in the summaries are skipped without being read
+*/
+static bool loadResultBlock(BitSetIterator *iterator) {
+  const size_t endWord = (iterator->endBlock + BIT_PER_BLOCK - 1) / BIT_PER_BLOCK;
+
+  while (iterator->block == 0 &&
+         (iterator->candidates != 0 || iterator->wordPos < endWord)) {
+    if (iterator->candidates == 0) {
+      iterator->candidates = combineSummaryWords(iterator, iterator->wordPos);
+      iterator->wordPos++;
+    } else {
+      const int leadingZeros = __builtin_clzll(iterator->candidates);
+      iterator->candidates &= ~(1ULL << (BIT_PER_BLOCK - leadingZeros - 1));
+
+      iterator->blockPos =
+          (iterator->wordPos - 1) * BIT_PER_BLOCK + leadingZeros;
+      iterator->block = combineBlocks(iterator, iterator->blockPos);
+    }
+  }
+
+  return iterator->block != 0;
+}
+
+void limitBitSetIterator(BitSetIterator *iterator, size_t offset,
+                         const size_t limit) {
+  while (offset > 0 && loadResultBlock(iterator)) {
+    const size_t blockCount = (size_t)__builtin_popcountll(iterator->block);
+
+    if (blockCount <= offset) {
+      offset -= blockCount;
+      iterator->block = 0;
+    } else {
+      for (; offset > 0; offset--) {
+        iterator->block = clearFirstElement(iterator->block);
+      }
+    }
+  }
+
+  iterator->remaining = limit;
+}
+
+bool nextBitSetIteratorElement(BitSetIterator *iterator, uint64_t *element) {
+  bool isFound = false;
+
+  if (iterator->remaining > 0 && loadResultBlock(iterator)) {
+    const int leadingZeros = __builtin_clzll(iterator->block);
+    iterator->block = clearFirstElement(iterator->block);
+
+    *element = (uint64_t)iterator->blockPos * BIT_PER_BLOCK + leadingZeros;
+    iterator->remaining--;
+    isFound = true;
+  }
+
+  return isFound;
+}
+
+size_t nextBitSetIteratorElements(BitSetIterator *iterator, const size_t count,
+                                  uint64_t elements[]) {
+  size_t written = 0;
+
+  while (written < count &&
+         nextBitSetIteratorElement(iterator, &elements[written])) {
+    written++;
+  }
+
+  return written;
+}
@@ -0,0 +1,77 @@
+#ifndef ITERATOR_H
+#define ITERATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+typedef enum {
+  ITERATE_UNION,
+  ITERATE_INTERSECTION,
+  ITERATE_DIFFERENCE,
+  ITERATE_SYMMETRIC_DIFFERENCE,
+} IteratorOperation;
+
+typedef struct BitSetIterator {
+  const BitSet *bitSetA;
+  const BitSet *bitSetB;        // NULL when a single set is iterated
+  IteratorOperation operation;
+  size_t endBlock;              // Block after the last one of the result
+  size_t wordPos;               // Next summary word to combine
+  uint64_t candidates;          // Unvisited blocks of the summary word
+  size_t blockPos;              // Block of the current result block
+  uint64_t block;               // Unvisited elements of the result block
+  size_t remaining;             // Elements left before the limit
+} BitSetIterator;
+
+/*
+  Creates an iterator over the elements of the set in ascending order.
+  The set must not change while it is iterated
+*/
+BitSetIterator createBitSetIterator(const BitSet *bitSet);
+
+/*
+  Creates an iterator over А ∪ В without building the result set
+*/
+BitSetIterator createBitSetsUnionIterator(const BitSet *bitSetA,
+                                          const BitSet *bitSetB);
+
+/*
+  Creates an iterator over А ∩ В without building the result set
+*/
+BitSetIterator createBitSetsIntersectionIterator(const BitSet *bitSetA,
+                                                 const BitSet *bitSetB);
+
+/*
+  Creates an iterator over А - В without building the result set
+*/
+BitSetIterator createBitSetsDiffIterator(const BitSet *bitSetA,
+                                         const BitSet *bitSetB);
+
+/*
+  Creates an iterator over А △ В without building the result set
+*/
+BitSetIterator createSymmetricBitSetsDiffIterator(const BitSet *bitSetA,
+                                                  const BitSet *bitSetB);
+
+/*
+  Skips the next offset elements and stops the iterator after
+  limit more ones. Whole blocks are skipped by their population count
+*/
+void limitBitSetIterator(BitSetIterator *iterator, size_t offset, size_t limit);
+
+/*
+  Writes the next element. If there are no more, false returns
+*/
+bool nextBitSetIteratorElement(BitSetIterator *iterator, uint64_t *element);
+
+/*
+  Writes up to count next elements and returns how many were written
+*/
+size_t nextBitSetIteratorElements(BitSetIterator *iterator, size_t count,
+                                  uint64_t elements[]);
+
+#endif
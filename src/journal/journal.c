@@ -0,0 +1,616 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "journal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../delta/delta.h"
+
+#define JOURNAL_HEADER_SIZE (MAGIC_LENGTH + sizeof(uint64_t))
+#define CHECKPOINT_HEADER_SIZE (MAGIC_LENGTH + 1 + sizeof(uint64_t))
+#define MAX_RECORD_SIZE 21
+#define MAX_VARINT_LENGTH 10
+
+typedef enum {
+  JOURNAL_ADD = 1,
+  JOURNAL_REMOVE,
+  JOURNAL_ADD_RANGE,
+  JOURNAL_REMOVE_RANGE,
+} JournalOperation;
+
+typedef enum {
+  FULL_CHECKPOINT,
+  COMPRESSED_CHECKPOINT,
+} CheckpointKind;
+
+static void writeLittleEndian(uint8_t *bytes, uint64_t value) {
+  for (size_t iter = 0; iter < sizeof(uint64_t); iter++) {
+    bytes[iter] = (uint8_t)(value >> (8 * iter));
+  }
+}
+
+static uint64_t readLittleEndian(const uint8_t *bytes) {
+  uint64_t value = 0;
+  for (size_t iter = 0; iter < sizeof(uint64_t); iter++) {
+    value |= (uint64_t)bytes[iter] << (8 * iter);
+  }
+
+  return value;
+}
+
+static size_t writeVarint(uint8_t *bytes, uint64_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    bytes[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  bytes[length++] = (uint8_t)value;
+
+  return length;
+}
+
+static bool readVarint(const uint8_t *bytes, const size_t length,
+                       size_t *position, uint64_t *value) {
+  bool isRead = false;
+  uint64_t result = 0;
+  size_t shift = 0;
+
+  while (!isRead && shift < 7 * MAX_VARINT_LENGTH && *position < length) {
+    const uint8_t byte = bytes[(*position)++];
+    result |= (uint64_t)(byte & 0x7F) << shift;
+    shift += 7;
+    isRead = (byte & 0x80) == 0;
+  }
+
+  *value = result;
+  return isRead;
+}
+
+/*
+  Writes the whole buffer, repeating short and interrupted writes
+*/
+static BaseErrorCode writeAll(const int fd, const uint8_t *buffer,
+                              const size_t length) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  size_t written = 0;
+
+  while (written < length && !statusCode) {
+    const ssize_t result = write(fd, buffer + written, length - written);
+    if (result >= 0) {
+      written += (size_t)result;
+    } else if (errno != EINTR) {
+      statusCode = FILE_WRITE_ERROR;
+    }
+  }
+
+  return statusCode;
+}
+
+/*
+  Reads the whole file into memory. A missing file is reported
+  with ELEMENT_NOT_FOUND_ERROR
+*/
+static BaseErrorCode readWholeFile(const char *path, uint8_t **data,
+                                   size_t *length) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  struct stat fileStat;
+
+  *data = NULL;
+  *length = 0;
+
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    statusCode = errno == ENOENT ? ELEMENT_NOT_FOUND_ERROR : FILE_READ_ERROR;
+  } else if (fstat(fd, &fileStat) != 0) {
+    statusCode = FILE_READ_ERROR;
+  } else {
+    *data = malloc(fileStat.st_size > 0 ? (size_t)fileStat.st_size : 1);
+    if (*data == NULL) {
+      statusCode = MEMORY_ALLOCATION_ERROR;
+    }
+  }
+
+  while (!statusCode && *length < (size_t)fileStat.st_size) {
+    const ssize_t result =
+        read(fd, *data + *length, (size_t)fileStat.st_size - *length);
+    if (result > 0) {
+      *length += (size_t)result;
+    } else if (result == 0) {
+      statusCode = FILE_READ_ERROR;
+    } else if (errno != EINTR) {
+      statusCode = FILE_READ_ERROR;
+    }
+  }
+
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (statusCode) {
+    free(*data);
+    *data = NULL;
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode openBitSetJournal(BitSetJournal *journal, const char *path,
+                                const size_t capacity, const size_t groupSize) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  uint8_t header[JOURNAL_HEADER_SIZE];
+  struct stat fileStat;
+
+  journal->capacity = capacity;
+  journal->length = 0;
+  journal->pendingCount = 0;
+  journal->groupSize = groupSize > 0 ? groupSize : 1;
+  journal->buffer = malloc(JOURNAL_BUFFER_SIZE);
+  journal->fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+
+  if (journal->buffer == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  } else if (journal->fd < 0 || fstat(journal->fd, &fileStat) != 0) {
+    statusCode = FILE_WRITE_ERROR;
+  } else if (fileStat.st_size == 0) {
+    memcpy(header, JOURNAL_MAGIC, MAGIC_LENGTH);
+    writeLittleEndian(header + MAGIC_LENGTH, capacity);
+    statusCode = writeAll(journal->fd, header, JOURNAL_HEADER_SIZE);
+    if (!statusCode && fsync(journal->fd) != 0) {
+      statusCode = FILE_WRITE_ERROR;
+    }
+  } else if (pread(journal->fd, header, JOURNAL_HEADER_SIZE, 0) !=
+                 (ssize_t)JOURNAL_HEADER_SIZE ||
+             memcmp(header, JOURNAL_MAGIC, MAGIC_LENGTH) != 0 ||
+             readLittleEndian(header + MAGIC_LENGTH) != capacity) {
+    // The existing journal belongs to another set
+    statusCode = INVALID_ARGUMENT_ERROR;
+  }
+
+  if (statusCode) {
+    if (journal->fd >= 0) {
+      close(journal->fd);
+    }
+    journal->fd = -1;
+    free(journal->buffer);
+    journal->buffer = NULL;
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode closeBitSetJournal(BitSetJournal *journal) {
+  const BaseErrorCode statusCode = commitBitSetJournal(journal);
+
+  close(journal->fd);
+  journal->fd = -1;
+  free(journal->buffer);
+  journal->buffer = NULL;
+
+  return statusCode;
+}
+
+BaseErrorCode commitBitSetJournal(BitSetJournal *journal) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  if (journal->length > 0) {
+    const off_t committedLength = lseek(journal->fd, 0, SEEK_END);
+    if (committedLength < 0) {
+      statusCode = FILE_WRITE_ERROR;
+    } else {
+      statusCode = writeAll(journal->fd, journal->buffer, journal->length);
+      if (!statusCode && fsync(journal->fd) != 0) {
+        statusCode = FILE_WRITE_ERROR;
+      }
+
+      // A partly written group is cut off, so that a retry appends the
+      // buffer right after the last complete record
+      if (statusCode) {
+        (void)ftruncate(journal->fd, committedLength);
+      }
+    }
+  }
+
+  if (!statusCode) {
+    journal->length = 0;
+    journal->pendingCount = 0;
+  }
+
+  return statusCode;
+}
+
+/*
+  Appends a record to the buffer and commits the group when it is full.
+  If the commit fails, the record is taken back out of the buffer
+*/
+static BaseErrorCode appendJournalRecord(BitSetJournal *journal,
+                                         const JournalOperation operation,
+                                         const uint64_t first,
+                                         const uint64_t count) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  if (journal->length + MAX_RECORD_SIZE > JOURNAL_BUFFER_SIZE) {
+    statusCode = commitBitSetJournal(journal);
+  }
+
+  if (!statusCode) {
+    const size_t recordStart = journal->length;
+
+    journal->buffer[journal->length++] = (uint8_t)operation;
+    journal->length += writeVarint(journal->buffer + journal->length, first);
+    if (operation == JOURNAL_ADD_RANGE || operation == JOURNAL_REMOVE_RANGE) {
+      journal->length += writeVarint(journal->buffer + journal->length, count);
+    }
+    journal->pendingCount++;
+
+    if (journal->pendingCount >= journal->groupSize) {
+      statusCode = commitBitSetJournal(journal);
+    }
+
+    if (statusCode) {
+      journal->length = recordStart;
+      journal->pendingCount--;
+    }
+  }
+
+  return statusCode;
+}
+
+/*
+  Checks the record against the set without changing anything
+*/
+static BaseErrorCode checkJournalRecord(const BitSet *bitSet,
+                                        const JournalOperation operation,
+                                        const uint64_t first,
+                                        const uint64_t count) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  const uint64_t capacity = (uint64_t)bitSet->capacity;
+
+  if (operation == JOURNAL_ADD_RANGE || operation == JOURNAL_REMOVE_RANGE) {
+    if (first > capacity + 1 || count > capacity + 1 - first) {
+      statusCode = CAPACITY_EXCEEDING_ERROR;
+    }
+  } else if (first > capacity) {
+    statusCode = CAPACITY_EXCEEDING_ERROR;
+  }
+
+  return statusCode;
+}
+
+static void applyJournalRecord(const BitSet *bitSet,
+                               const JournalOperation operation,
+                               const uint64_t first, const uint64_t count) {
+  switch (operation) {
+    case JOURNAL_ADD:
+      addBitSetElement(bitSet, first);
+      break;
+    case JOURNAL_REMOVE:
+      removeBitSetElement(bitSet, first);
+      break;
+    case JOURNAL_ADD_RANGE:
+      addBitSetRange(bitSet, first, first + count);
+      break;
+    default:
+      removeBitSetRange(bitSet, first, first + count);
+  }
+}
+
+/*
+  Records the change first and applies it only once the record is
+  accepted, so that the set never holds a change missing from the log
+*/
+static BaseErrorCode journalBitSetChange(BitSetJournal *journal,
+                                         const BitSet *bitSet,
+                                         const JournalOperation operation,
+                                         const uint64_t first,
+                                         const uint64_t count) {
+  BaseErrorCode statusCode =
+      checkJournalRecord(bitSet, operation, first, count);
+
+  if (!statusCode) {
+    statusCode = appendJournalRecord(journal, operation, first, count);
+  }
+  if (!statusCode) {
+    applyJournalRecord(bitSet, operation, first, count);
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode journalAddBitSetElement(BitSetJournal *journal,
+                                      const BitSet *bitSet,
+                                      const uint64_t element) {
+  return journalBitSetChange(journal, bitSet, JOURNAL_ADD, element, 0);
+}
+
+BaseErrorCode journalRemoveBitSetElement(BitSetJournal *journal,
+                                         const BitSet *bitSet,
+                                         const uint64_t element) {
+  return journalBitSetChange(journal, bitSet, JOURNAL_REMOVE, element, 0);
+}
+
+BaseErrorCode journalAddBitSetRange(BitSetJournal *journal,
+                                    const BitSet *bitSet, const uint64_t from,
+                                    const uint64_t to) {
+  return from > to ? INVALID_ARGUMENT_ERROR
+                   : journalBitSetChange(journal, bitSet, JOURNAL_ADD_RANGE,
+                                         from, to - from);
+}
+
+BaseErrorCode journalRemoveBitSetRange(BitSetJournal *journal,
+                                       const BitSet *bitSet,
+                                       const uint64_t from, const uint64_t to) {
+  return from > to ? INVALID_ARGUMENT_ERROR
+                   : journalBitSetChange(journal, bitSet, JOURNAL_REMOVE_RANGE,
+                                         from, to - from);
+}
+
+/*
+  Builds the checkpoint contents. The compressed form lists only the
+  non-empty blocks and is chosen when it is smaller than the full one
+*/
+static BaseErrorCode buildCheckpoint(const BitSet *bitSet, uint8_t **data,
+                                     size_t *length) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  const size_t summarySize = getBitSetSummarySize(bitSet);
+  size_t nonEmptyBlocks = 0;
+
+  // Blocks outside the summary and the active range are known to be empty
+  for (size_t wordPos = 0; wordPos < summarySize; wordPos++) {
+    uint64_t candidates = getBitSetSummaryWord(bitSet, wordPos);
+
+    while (candidates != 0) {
+      const int leadingZeros = __builtin_clzll(candidates);
+      candidates &= ~(1ULL << (BIT_PER_BLOCK - leadingZeros - 1));
+      nonEmptyBlocks +=
+          bitSet->bits[wordPos * BIT_PER_BLOCK + leadingZeros] != 0;
+    }
+  }
+
+  // A compressed block takes up to 12 bytes against 8 bytes of a full one
+  const CheckpointKind kind = nonEmptyBlocks * 3 < bitSet->size * 2
+                                  ? COMPRESSED_CHECKPOINT
+                                  : FULL_CHECKPOINT;
+
+  BitSetDelta delta = {NULL, 0};
+  size_t payloadLength = bitSet->size * sizeof(uint64_t);
+
+  if (kind == COMPRESSED_CHECKPOINT) {
+    statusCode = createBitSetDeltaFromEmpty(bitSet, &delta);
+    payloadLength = delta.length;
+  }
+
+  if (!statusCode) {
+    *length = CHECKPOINT_HEADER_SIZE + payloadLength;
+    *data = malloc(*length);
+    statusCode = *data == NULL ? MEMORY_ALLOCATION_ERROR : NONE_ERROR;
+  }
+
+  if (!statusCode) {
+    uint8_t *payload = *data + CHECKPOINT_HEADER_SIZE;
+    memcpy(*data, CHECKPOINT_MAGIC, MAGIC_LENGTH);
+    (*data)[MAGIC_LENGTH] = (uint8_t)kind;
+    writeLittleEndian(*data + MAGIC_LENGTH + 1, bitSet->capacity);
+
+    if (kind == COMPRESSED_CHECKPOINT) {
+      memcpy(payload, delta.data, delta.length);
+    } else {
+      for (size_t blockPos = 0; blockPos < bitSet->size; blockPos++) {
+        writeLittleEndian(payload + blockPos * sizeof(uint64_t),
+                          bitSet->bits[blockPos]);
+      }
+    }
+  }
+
+  destroyBitSetDelta(&delta);
+
+  return statusCode;
+}
+
+/*
+  Syncs the directory which holds the path, so that a rename inside it
+  is durable
+*/
+static BaseErrorCode syncParentDirectory(const char *path) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  char *pathCopy = strdup(path);
+
+  if (pathCopy == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  } else {
+    const int fd = open(dirname(pathCopy), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+      statusCode = FILE_WRITE_ERROR;
+    } else {
+      if (fsync(fd) != 0) {
+        statusCode = FILE_WRITE_ERROR;
+      }
+      close(fd);
+    }
+  }
+
+  free(pathCopy);
+
+  return statusCode;
+}
+
+BaseErrorCode checkpointBitSetJournal(BitSetJournal *journal,
+                                      const BitSet *bitSet,
+                                      const char *checkpointPath) {
+  BaseErrorCode statusCode = commitBitSetJournal(journal);
+  uint8_t *data = NULL;
+  size_t length = 0;
+
+  char *temporaryPath = malloc(strlen(checkpointPath) + sizeof(".tmp"));
+  if (!statusCode && temporaryPath == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  }
+
+  if (!statusCode) {
+    statusCode = buildCheckpoint(bitSet, &data, &length);
+  }
+
+  // The snapshot replaces the old one only after it is fully on disk
+  if (!statusCode) {
+    strcpy(temporaryPath, checkpointPath);
+    strcat(temporaryPath, ".tmp");
+
+    const int fd = open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      statusCode = FILE_WRITE_ERROR;
+    } else {
+      statusCode = writeAll(fd, data, length);
+      if (!statusCode && fsync(fd) != 0) {
+        statusCode = FILE_WRITE_ERROR;
+      }
+      close(fd);
+    }
+  }
+
+  if (!statusCode && rename(temporaryPath, checkpointPath) != 0) {
+    statusCode = FILE_WRITE_ERROR;
+  }
+
+  // The journal may only be truncated once the rename is durable, otherwise
+  // a crash could leave the old checkpoint with an empty journal
+  if (!statusCode) {
+    statusCode = syncParentDirectory(checkpointPath);
+  }
+
+  // Replaying the records again on the new checkpoint gives the same set,
+  // so a crash before the truncation is harmless
+  if (!statusCode && (ftruncate(journal->fd, JOURNAL_HEADER_SIZE) != 0 ||
+                      fsync(journal->fd) != 0)) {
+    statusCode = FILE_WRITE_ERROR;
+  }
+
+  free(temporaryPath);
+  free(data);
+
+  return statusCode;
+}
+
+static BaseErrorCode loadCheckpoint(const uint8_t *data, const size_t length,
+                                    BitSet *bitSet) {
+  BaseErrorCode statusCode = NONE_ERROR;
+
+  if (length < CHECKPOINT_HEADER_SIZE ||
+      memcmp(data, CHECKPOINT_MAGIC, MAGIC_LENGTH) != 0) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  } else {
+    *bitSet = createBitSet(readLittleEndian(data + MAGIC_LENGTH + 1));
+    if (bitSet->bits == NULL) {
+      statusCode = MEMORY_ALLOCATION_ERROR;
+    }
+  }
+
+  const uint8_t *payload = data + CHECKPOINT_HEADER_SIZE;
+  const size_t payloadLength = length - CHECKPOINT_HEADER_SIZE;
+
+  if (!statusCode && data[MAGIC_LENGTH] == COMPRESSED_CHECKPOINT) {
+    const BitSetDelta delta = {(uint8_t *)payload, payloadLength};
+    statusCode = applyBitSetDelta(bitSet, &delta);
+  } else if (!statusCode && data[MAGIC_LENGTH] == FULL_CHECKPOINT &&
+             payloadLength == bitSet->size * sizeof(uint64_t)) {
+    for (size_t blockPos = 0; blockPos < bitSet->size; blockPos++) {
+      setBitSetBlock(bitSet, blockPos,
+                     readLittleEndian(payload + blockPos * sizeof(uint64_t)));
+    }
+  } else if (!statusCode) {
+    statusCode = INVALID_ARGUMENT_ERROR;
+  }
+
+  if (statusCode) {
+    destroyBitSet(bitSet);
+  }
+
+  return statusCode;
+}
+
+/*
+  Applies the records one by one until the end or the first record
+  which is incomplete
+*/
+static void replayJournal(const uint8_t *data, const size_t length,
+                          const BitSet *bitSet) {
+  size_t position = JOURNAL_HEADER_SIZE;
+  bool isValid = true;
+
+  while (isValid && position < length) {
+    const uint8_t operation = data[position++];
+    uint64_t first = 0;
+    uint64_t count = 0;
+
+    isValid = readVarint(data, length, &position, &first);
+    if (operation == JOURNAL_ADD_RANGE || operation == JOURNAL_REMOVE_RANGE) {
+      isValid = isValid && readVarint(data, length, &position, &count);
+    }
+
+    isValid = isValid && operation >= JOURNAL_ADD &&
+              operation <= JOURNAL_REMOVE_RANGE;
+
+    if (isValid &&
+        !checkJournalRecord(bitSet, operation, first, count)) {
+      applyJournalRecord(bitSet, operation, first, count);
+    }
+  }
+}
+
+BaseErrorCode recoverBitSet(const char *journalPath, const char *checkpointPath,
+                            BitSet *bitSet) {
+  uint8_t *checkpointData = NULL;
+  uint8_t *journalData = NULL;
+  size_t checkpointLength = 0;
+  size_t journalLength = 0;
+  bool hasCheckpoint = false;
+
+  bitSet->bits = NULL;
+  bitSet->summary = NULL;
+  bitSet->activeRange = NULL;
+
+  BaseErrorCode statusCode =
+      readWholeFile(checkpointPath, &checkpointData, &checkpointLength);
+  if (!statusCode) {
+    statusCode = loadCheckpoint(checkpointData, checkpointLength, bitSet);
+    hasCheckpoint = statusCode == NONE_ERROR;
+  } else if (statusCode == ELEMENT_NOT_FOUND_ERROR) {
+    statusCode = NONE_ERROR;
+  }
+
+  if (!statusCode) {
+    statusCode = readWholeFile(journalPath, &journalData, &journalLength);
+    if (statusCode == ELEMENT_NOT_FOUND_ERROR && hasCheckpoint) {
+      statusCode = NONE_ERROR;
+    }
+  }
+
+  if (!statusCode && journalData != NULL) {
+    if (journalLength < JOURNAL_HEADER_SIZE ||
+        memcmp(journalData, JOURNAL_MAGIC, MAGIC_LENGTH) != 0 ||
+        (hasCheckpoint && readLittleEndian(journalData + MAGIC_LENGTH) !=
+                              (uint64_t)bitSet->capacity)) {
+      statusCode = INVALID_ARGUMENT_ERROR;
+    } else if (!hasCheckpoint) {
+      *bitSet = createBitSet(readLittleEndian(journalData + MAGIC_LENGTH));
+      statusCode = bitSet->bits == NULL ? MEMORY_ALLOCATION_ERROR : NONE_ERROR;
+    }
+
+    if (!statusCode) {
+      replayJournal(journalData, journalLength, bitSet);
+    }
+  }
+
+  if (statusCode && bitSet->bits != NULL) {
+    destroyBitSet(bitSet);
+  }
+
+  free(checkpointData);
+  free(journalData);
+
+  return statusCode;
+}
@@ -0,0 +1,89 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+#define JOURNAL_BUFFER_SIZE (1 << 16)
+#define JOURNAL_MAGIC "BSJL"
+#define CHECKPOINT_MAGIC "BSCP"
+#define MAGIC_LENGTH 4
+
+typedef struct BitSetJournal {
+  int fd;               // Append-only journal file
+  uint64_t capacity;    // Capacity of the journaled set
+  uint8_t *buffer;      // Records waiting for the group commit
+  size_t length;        // Number of bytes in the buffer
+  size_t pendingCount;  // Number of records in the buffer
+  size_t groupSize;     // Number of records committed together
+} BitSetJournal;
+
+/*
+  Opens or creates the journal of a set with the given capacity.
+  Records are written and synced in groups of groupSize
+*/
+BaseErrorCode openBitSetJournal(BitSetJournal *journal, const char *path,
+                                size_t capacity, size_t groupSize);
+
+/*
+  Commits the pending records and closes the journal
+*/
+BaseErrorCode closeBitSetJournal(BitSetJournal *journal);
+
+/*
+  Writes the pending records to the file and waits until they are durable.
+  On failure the records stay pending and the file keeps only whole groups
+*/
+BaseErrorCode commitBitSetJournal(BitSetJournal *journal);
+
+/*
+  Records the addition of an element in the journal, then adds it to the
+  set. If the record cannot be committed, the set is not changed
+*/
+BaseErrorCode journalAddBitSetElement(BitSetJournal *journal,
+                                      const BitSet *bitSet, uint64_t element);
+
+/*
+  Records the removal of an element in the journal, then removes it
+  from the set
+*/
+BaseErrorCode journalRemoveBitSetElement(BitSetJournal *journal,
+                                         const BitSet *bitSet,
+                                         uint64_t element);
+
+/*
+  Records the addition of [from, to) in the journal, then adds the
+  numbers to the set
+*/
+BaseErrorCode journalAddBitSetRange(BitSetJournal *journal,
+                                    const BitSet *bitSet, uint64_t from,
+                                    uint64_t to);
+
+/*
+  Records the removal of [from, to) in the journal, then removes the
+  numbers from the set
+*/
+BaseErrorCode journalRemoveBitSetRange(BitSetJournal *journal,
+                                       const BitSet *bitSet, uint64_t from,
+                                       uint64_t to);
+
+/*
+  Writes a snapshot of the set to the checkpoint file and empties the
+  journal. Sparse sets are stored as a delta from the empty set
+*/
+BaseErrorCode checkpointBitSetJournal(BitSetJournal *journal,
+                                      const BitSet *bitSet,
+                                      const char *checkpointPath);
+
+/*
+  Creates the set from the last checkpoint, if there is one, and replays
+  the journal on top of it. A torn record at the end is ignored.
+  If neither file exists, ELEMENT_NOT_FOUND_ERROR returns
+*/
+BaseErrorCode recoverBitSet(const char *journalPath, const char *checkpointPath,
+                            BitSet *bitSet);
+
+#endif
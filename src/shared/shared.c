@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "shared.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static size_t getBlockCount(const uint64_t capacity) {
+  return capacity / BIT_PER_BLOCK + 1;
+}
+
+static size_t getMappingSize(const uint64_t capacity) {
+  return sizeof(SharedBitSetHeader) + getBlockCount(capacity) * sizeof(uint64_t);
+}
+
+/*
+  Maps the segment and points the set at the blocks after the header
+*/
+static BaseErrorCode mapSharedBitSet(const int fd, const size_t mappingSize,
+                                     SharedBitSet *sharedBitSet) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  void *mapping =
+      mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if (mapping == MAP_FAILED) {
+    statusCode = SHARED_MEMORY_ERROR;
+  } else {
+    sharedBitSet->header = mapping;
+    sharedBitSet->mappingSize = mappingSize;
+    sharedBitSet->bitSet.bits = (uint64_t *)(sharedBitSet->header + 1);
+    sharedBitSet->bitSet.summary = NULL;
+    sharedBitSet->bitSet.activeRange = NULL;
+  }
+
+  return statusCode;
+}
+
+static void resetSharedBitSet(SharedBitSet *sharedBitSet) {
+  sharedBitSet->bitSet.bits = NULL;
+  sharedBitSet->bitSet.size = 0;
+  sharedBitSet->bitSet.capacity = 0;
+  sharedBitSet->bitSet.summary = NULL;
+  sharedBitSet->bitSet.activeRange = NULL;
+  sharedBitSet->header = NULL;
+  sharedBitSet->mappingSize = 0;
+}
+
+BaseErrorCode createSharedBitSet(const char *name, const size_t capacity,
+                                 SharedBitSet *sharedBitSet) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  const size_t mappingSize = getMappingSize(capacity);
+
+  resetSharedBitSet(sharedBitSet);
+  const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+  if (fd < 0) {
+    statusCode = SHARED_MEMORY_ERROR;
+  } else {
+    // The new segment is zero-filled, so the set starts empty
+    if (ftruncate(fd, (off_t)mappingSize) != 0) {
+      statusCode = SHARED_MEMORY_ERROR;
+    } else {
+      statusCode = mapSharedBitSet(fd, mappingSize, sharedBitSet);
+    }
+    close(fd);
+
+    if (statusCode) {
+      shm_unlink(name);
+    }
+  }
+
+  if (!statusCode) {
+    sharedBitSet->bitSet.capacity = capacity;
+    sharedBitSet->bitSet.size = getBlockCount(capacity);
+    sharedBitSet->header->capacity = capacity;
+
+    // Processes which attach before this store see an unfinished segment
+    __atomic_store_n(&sharedBitSet->header->magic, SHARED_BITSET_MAGIC,
+                     __ATOMIC_RELEASE);
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode attachSharedBitSet(const char *name,
+                                 SharedBitSet *sharedBitSet) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  struct stat segmentStat;
+
+  resetSharedBitSet(sharedBitSet);
+  const int fd = shm_open(name, O_RDWR, 0);
+
+  if (fd < 0) {
+    statusCode = SHARED_MEMORY_ERROR;
+  } else {
+    if (fstat(fd, &segmentStat) != 0 ||
+        (size_t)segmentStat.st_size < sizeof(SharedBitSetHeader)) {
+      statusCode = SHARED_MEMORY_ERROR;
+    } else {
+      statusCode = mapSharedBitSet(fd, (size_t)segmentStat.st_size,
+                                   sharedBitSet);
+    }
+    close(fd);
+  }
+
+  if (!statusCode) {
+    const SharedBitSetHeader *header = sharedBitSet->header;
+
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) !=
+            SHARED_BITSET_MAGIC ||
+        getMappingSize(header->capacity) != sharedBitSet->mappingSize) {
+      statusCode = SHARED_MEMORY_ERROR;
+      detachSharedBitSet(sharedBitSet);
+    } else {
+      sharedBitSet->bitSet.capacity = header->capacity;
+      sharedBitSet->bitSet.size = getBlockCount(header->capacity);
+    }
+  }
+
+  return statusCode;
+}
+
+void detachSharedBitSet(SharedBitSet *sharedBitSet) {
+  if (sharedBitSet->header != NULL) {
+    munmap(sharedBitSet->header, sharedBitSet->mappingSize);
+  }
+  resetSharedBitSet(sharedBitSet);
+}
+
+BaseErrorCode removeSharedBitSet(const char *name) {
+  return shm_unlink(name) == 0 ? NONE_ERROR : SHARED_MEMORY_ERROR;
+}
+
+/*
+  Applies the mask to the block of the element between the two update
+  counters, so that snapshots can tell an update was running
+*/
+static BaseErrorCode updateSharedBitSet(const SharedBitSet *sharedBitSet,
+                                        const uint64_t element,
+                                        const bool isAdded) {
+  BaseErrorCode statusCode = CAPACITY_EXCEEDING_ERROR;
+  SharedBitSetHeader *header = sharedBitSet->header;
+
+  if (element <= (uint64_t)sharedBitSet->bitSet.capacity) {
+    uint64_t *block = &sharedBitSet->bitSet.bits[element / BIT_PER_BLOCK];
+    const uint64_t mask = 1ULL << (BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1);
+
+    __atomic_fetch_add(&header->startedUpdates, 1, __ATOMIC_SEQ_CST);
+    if (isAdded) {
+      __atomic_fetch_or(block, mask, __ATOMIC_SEQ_CST);
+    } else {
+      __atomic_fetch_and(block, ~mask, __ATOMIC_SEQ_CST);
+    }
+    __atomic_fetch_add(&header->finishedUpdates, 1, __ATOMIC_SEQ_CST);
+
+    statusCode = NONE_ERROR;
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode addSharedBitSetElement(const SharedBitSet *sharedBitSet,
+                                     const uint64_t element) {
+  return updateSharedBitSet(sharedBitSet, element, true);
+}
+
+BaseErrorCode removeSharedBitSetElement(const SharedBitSet *sharedBitSet,
+                                        const uint64_t element) {
+  return updateSharedBitSet(sharedBitSet, element, false);
+}
+
+bool isSharedBitSetContains(const SharedBitSet *sharedBitSet,
+                            const uint64_t element) {
+  bool isContains = false;
+
+  if (element <= (uint64_t)sharedBitSet->bitSet.capacity) {
+    const uint64_t block = __atomic_load_n(
+        &sharedBitSet->bitSet.bits[element / BIT_PER_BLOCK], __ATOMIC_ACQUIRE);
+    isContains = block >> (BIT_PER_BLOCK - element % BIT_PER_BLOCK - 1) & 1;
+  }
+
+  return isContains;
+}
+
+uint64_t getSharedBitSetGeneration(const SharedBitSet *sharedBitSet) {
+  return __atomic_load_n(&sharedBitSet->header->finishedUpdates,
+                         __ATOMIC_ACQUIRE);
+}
+
+BaseErrorCode getSharedBitSetSnapshot(const SharedBitSet *sharedBitSet,
+                                      BitSet *snapshot, uint64_t *generation) {
+  BaseErrorCode statusCode = NONE_ERROR;
+  SharedBitSetHeader *header = sharedBitSet->header;
+
+  *snapshot = createBitSet(sharedBitSet->bitSet.capacity);
+  if (snapshot->bits == NULL) {
+    statusCode = MEMORY_ALLOCATION_ERROR;
+  }
+
+  bool isConsistent = false;
+  for (size_t attempt = 0;
+       !statusCode && !isConsistent && attempt < SHARED_SNAPSHOT_ATTEMPTS;
+       attempt++) {
+    const uint64_t started =
+        __atomic_load_n(&header->startedUpdates, __ATOMIC_SEQ_CST);
+    *generation = __atomic_load_n(&header->finishedUpdates, __ATOMIC_SEQ_CST);
+
+    // Every update which has begun is finished, so the blocks are settled
+    if (started == *generation) {
+      for (size_t blockPos = 0; blockPos < snapshot->size; blockPos++) {
+        snapshot->bits[blockPos] = __atomic_load_n(
+            &sharedBitSet->bitSet.bits[blockPos], __ATOMIC_RELAXED);
+      }
+
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      isConsistent =
+          __atomic_load_n(&header->startedUpdates, __ATOMIC_SEQ_CST) == started;
+    }
+
+    if (!isConsistent) {
+      // Lets the running writers finish before the next attempt
+      sched_yield();
+    }
+  }
+
+  if (!statusCode && !isConsistent) {
+    statusCode = SHARED_SNAPSHOT_ERROR;
+    memset(snapshot->bits, 0, snapshot->size * sizeof(uint64_t));
+  }
+
+  return statusCode;
+}
+
+void repairSharedBitSet(const SharedBitSet *sharedBitSet) {
+  SharedBitSetHeader *header = sharedBitSet->header;
+
+  __atomic_store_n(&header->finishedUpdates,
+                   __atomic_load_n(&header->startedUpdates, __ATOMIC_SEQ_CST),
+                   __ATOMIC_SEQ_CST);
+}
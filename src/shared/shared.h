@@ -0,0 +1,92 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+#define SHARED_BITSET_MAGIC 0x4C485353ULL
+#define SHARED_SNAPSHOT_ATTEMPTS 1024
+
+typedef struct SharedBitSetHeader {
+  uint64_t magic;            // Written last, once the segment is ready
+  uint64_t capacity;         // Capacity of the shared set
+  uint64_t startedUpdates;   // Number of updates which have begun
+  uint64_t finishedUpdates;  // Number of completed updates, the generation
+  uint64_t reserved[4];      // Keeps the blocks on a cache line boundary
+} SharedBitSetHeader;
+
+typedef struct SharedBitSet {
+  BitSet bitSet;               // Its blocks live in the shared segment
+  SharedBitSetHeader *header;  // Start of the mapping
+  size_t mappingSize;          // Size of the mapping in bytes
+} SharedBitSet;
+
+/*
+  Creates a named shared memory segment for a set with the given capacity
+  and attaches to it. If the name is already taken, SHARED_MEMORY_ERROR
+  returns
+*/
+BaseErrorCode createSharedBitSet(const char *name, size_t capacity,
+                                 SharedBitSet *sharedBitSet);
+
+/*
+  Attaches to a set created by another process under the given name
+*/
+BaseErrorCode attachSharedBitSet(const char *name, SharedBitSet *sharedBitSet);
+
+/*
+  Unmaps the set from this process. The segment stays for the others
+*/
+void detachSharedBitSet(SharedBitSet *sharedBitSet);
+
+/*
+  Removes the name of the segment. It is freed after the last detach
+*/
+BaseErrorCode removeSharedBitSet(const char *name);
+
+/*
+  Atomically adds an element and moves the generation forward
+*/
+BaseErrorCode addSharedBitSetElement(const SharedBitSet *sharedBitSet,
+                                     uint64_t element);
+
+/*
+  Atomically removes an element and moves the generation forward
+*/
+BaseErrorCode removeSharedBitSetElement(const SharedBitSet *sharedBitSet,
+                                        uint64_t element);
+
+/*
+  Checks if there is an element in the set
+*/
+bool isSharedBitSetContains(const SharedBitSet *sharedBitSet,
+                            uint64_t element);
+
+/*
+  Returns the number of completed updates of the set
+*/
+uint64_t getSharedBitSetGeneration(const SharedBitSet *sharedBitSet);
+
+/*
+  Copies the set into a new private set. The copy is retried until no
+  update ran during it, so it matches the set at the written generation.
+  After SHARED_SNAPSHOT_ATTEMPTS failed attempts SHARED_SNAPSHOT_ERROR
+  returns and the snapshot is left empty. This happens under a steady
+  stream of writes, and for good if a writer died in the middle of an
+  update, see repairSharedBitSet
+*/
+BaseErrorCode getSharedBitSetSnapshot(const SharedBitSet *sharedBitSet,
+                                      BitSet *snapshot, uint64_t *generation);
+
+/*
+  Marks all begun updates as finished. A writer which dies in the middle
+  of an update leaves its update begun forever, so no snapshot can be
+  taken. Must only be called when no other writer is running. The block
+  of the dead writer has either its change or not, both are valid sets
+*/
+void repairSharedBitSet(const SharedBitSet *sharedBitSet);
+
+#endif
@@ -0,0 +1,199 @@
+#include "window.h"
+
+typedef enum {
+  WINDOW_UNION,
+  WINDOW_INTERSECTION,
+  WINDOW_DIFFERENCE,
+  WINDOW_SYMMETRIC_DIFFERENCE,
+} WindowOperation;
+
+WindowBitSet createWindowBitSet(const uint64_t low, const uint64_t high) {
+  WindowBitSet windowBitSet;
+
+  windowBitSet.base = low;
+  windowBitSet.bitSet = createBitSet(high > low ? high - low - 1 : 0);
+
+  return windowBitSet;
+}
+
+void destroyWindowBitSet(WindowBitSet *windowBitSet) {
+  destroyBitSet(&windowBitSet->bitSet);
+  windowBitSet->base = 0;
+}
+
+uint64_t getWindowBitSetEnd(const WindowBitSet *windowBitSet) {
+  return windowBitSet->base + windowBitSet->bitSet.capacity + 1;
+}
+
+BaseErrorCode addWindowBitSetElement(const WindowBitSet *windowBitSet,
+                                     const uint64_t element) {
+  BaseErrorCode statusCode = CAPACITY_EXCEEDING_ERROR;
+
+  if (element >= windowBitSet->base) {
+    statusCode =
+        addBitSetElement(&windowBitSet->bitSet, element - windowBitSet->base);
+  }
+
+  return statusCode;
+}
+
+BaseErrorCode removeWindowBitSetElement(const WindowBitSet *windowBitSet,
+                                        const uint64_t element) {
+  BaseErrorCode statusCode = CAPACITY_EXCEEDING_ERROR;
+
+  if (element >= windowBitSet->base) {
+    statusCode = removeBitSetElement(&windowBitSet->bitSet,
+                                     element - windowBitSet->base);
+  }
+
+  return statusCode;
+}
+
+bool isWindowBitSetContains(const WindowBitSet *windowBitSet,
+                            const uint64_t element) {
+  return element >= windowBitSet->base &&
+         isBitSetContains(&windowBitSet->bitSet, element - windowBitSet->base);
+}
+
+/*
+  Returns the bits of the numbers [start, start + 64) in block order.
+  If the window is aligned with start, this is one of its blocks,
+  otherwise two neighbouring blocks are funnel-shifted together
+*/
+static uint64_t readWindowBlock(const WindowBitSet *windowBitSet,
+                                const uint64_t start) {
+  const BitSet *bitSet = &windowBitSet->bitSet;
+  const int64_t relative = (int64_t)start - (int64_t)windowBitSet->base;
+  uint64_t block = 0;
+
+  if (relative % BIT_PER_BLOCK == 0) {
+    const int64_t blockPos = relative / BIT_PER_BLOCK;
+    if (blockPos >= 0 && (uint64_t)blockPos < bitSet->size) {
+      block = bitSet->bits[blockPos];
+    }
+  } else {
+    const int64_t blockPos = relative >= 0
+                                 ? relative / BIT_PER_BLOCK
+                                 : -((-relative + BIT_PER_BLOCK - 1) /
+                                     BIT_PER_BLOCK);
+    const int shift = (int)(relative - blockPos * BIT_PER_BLOCK);
+
+    if (blockPos >= 0 && (uint64_t)blockPos < bitSet->size) {
+      block |= bitSet->bits[blockPos] << shift;
+    }
+    if (blockPos + 1 >= 0 && (uint64_t)(blockPos + 1) < bitSet->size) {
+      block |= bitSet->bits[blockPos + 1] >> (BIT_PER_BLOCK - shift);
+    }
+  }
+
+  return block;
+}
+
+/*
+  Fills the result over [low, high) block by block. Only the blocks of
+  the result window are touched, the operands are read with an offset
+*/
+static WindowBitSet combineWindowBitSets(const WindowBitSet *windowBitSetA,
+                                         const WindowBitSet *windowBitSetB,
+                                         const uint64_t low,
+                                         const uint64_t high,
+                                         const WindowOperation operation) {
+  const WindowBitSet resultBitSet = createWindowBitSet(low, high);
+  const size_t resultSize = high > low ? resultBitSet.bitSet.size : 0;
+
+  for (size_t blockPos = 0;
+       resultBitSet.bitSet.bits != NULL && blockPos < resultSize; blockPos++) {
+    const uint64_t start = low + (uint64_t)blockPos * BIT_PER_BLOCK;
+    const uint64_t blockInA = readWindowBlock(windowBitSetA, start);
+    const uint64_t blockInB = readWindowBlock(windowBitSetB, start);
+
+    uint64_t resultBlock;
+    switch (operation) {
+      case WINDOW_UNION:
+        resultBlock = blockInA | blockInB;
+        break;
+      case WINDOW_INTERSECTION:
+        resultBlock = blockInA & blockInB;
+        break;
+      case WINDOW_DIFFERENCE:
+        resultBlock = blockInA & ~blockInB;
+        break;
+      default:
+        resultBlock = blockInA ^ blockInB;
+    }
+
+    if (resultBlock != 0) {
+      setBitSetBlock(&resultBitSet.bitSet, blockPos, resultBlock);
+    }
+  }
+
+  return resultBitSet;
+}
+
+static uint64_t getMinValue(const uint64_t valueA, const uint64_t valueB) {
+  return valueA < valueB ? valueA : valueB;
+}
+
+static uint64_t getMaxValue(const uint64_t valueA, const uint64_t valueB) {
+  return valueA > valueB ? valueA : valueB;
+}
+
+/*
+  Combines the sets over the window covering both of them. The cover also
+  holds the gap between the windows, so if the gap is wider than both
+  windows together, the result is refused and its bits are NULL
+*/
+static WindowBitSet coverWindowBitSets(const WindowBitSet *windowBitSetA,
+                                       const WindowBitSet *windowBitSetB,
+                                       const WindowOperation operation) {
+  const uint64_t low = getMinValue(windowBitSetA->base, windowBitSetB->base);
+  const uint64_t high = getMaxValue(getWindowBitSetEnd(windowBitSetA),
+                                    getWindowBitSetEnd(windowBitSetB));
+  const uint64_t windowsWidth = (uint64_t)windowBitSetA->bitSet.capacity +
+                                windowBitSetB->bitSet.capacity + 2;
+  const uint64_t gap = high - low > windowsWidth ? high - low - windowsWidth : 0;
+  WindowBitSet resultBitSet;
+
+  if (gap > windowsWidth) {
+    resultBitSet.base = low;
+    resultBitSet.bitSet.bits = NULL;
+    resultBitSet.bitSet.size = 0;
+    resultBitSet.bitSet.capacity = 0;
+    resultBitSet.bitSet.summary = NULL;
+    resultBitSet.bitSet.activeRange = NULL;
+  } else {
+    resultBitSet = combineWindowBitSets(windowBitSetA, windowBitSetB, low,
+                                        high, operation);
+  }
+
+  return resultBitSet;
+}
+
+WindowBitSet getWindowBitSetsUnion(const WindowBitSet *windowBitSetA,
+                                   const WindowBitSet *windowBitSetB) {
+  return coverWindowBitSets(windowBitSetA, windowBitSetB, WINDOW_UNION);
+}
+
+WindowBitSet getWindowBitSetsIntersection(const WindowBitSet *windowBitSetA,
+                                          const WindowBitSet *windowBitSetB) {
+  return combineWindowBitSets(
+      windowBitSetA, windowBitSetB,
+      getMaxValue(windowBitSetA->base, windowBitSetB->base),
+      getMinValue(getWindowBitSetEnd(windowBitSetA),
+                  getWindowBitSetEnd(windowBitSetB)),
+      WINDOW_INTERSECTION);
+}
+
+WindowBitSet getWindowBitSetsDiff(const WindowBitSet *windowBitSetA,
+                                  const WindowBitSet *windowBitSetB) {
+  return combineWindowBitSets(windowBitSetA, windowBitSetB,
+                              windowBitSetA->base,
+                              getWindowBitSetEnd(windowBitSetA),
+                              WINDOW_DIFFERENCE);
+}
+
+WindowBitSet getSymmetricWindowBitSetsDiff(const WindowBitSet *windowBitSetA,
+                                           const WindowBitSet *windowBitSetB) {
+  return coverWindowBitSets(windowBitSetA, windowBitSetB,
+                            WINDOW_SYMMETRIC_DIFFERENCE);
+}
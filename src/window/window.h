@@ -0,0 +1,81 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../bitset/bitset.h"
+#include "../errors/errors.h"
+
+typedef struct WindowBitSet {
+  BitSet bitSet;  // Elements counted from the base
+  uint64_t base;  // Smallest number of the window
+} WindowBitSet;
+
+/*
+  Creates a set of numbers in the window [low, high), only high - low
+  bits are allocated. Bounds must be below 2^63, and if high <= low the
+  window is [low, low + 1). In case of error, the bits of the inner set
+  are NULL
+*/
+WindowBitSet createWindowBitSet(uint64_t low, uint64_t high);
+
+/*
+  Removes the WindowBitSet structure
+*/
+void destroyWindowBitSet(WindowBitSet *windowBitSet);
+
+/*
+  Returns the number after the last one in the window
+*/
+uint64_t getWindowBitSetEnd(const WindowBitSet *windowBitSet);
+
+/*
+  Adds a number in set if it lies in the window
+*/
+BaseErrorCode addWindowBitSetElement(const WindowBitSet *windowBitSet,
+                                     uint64_t element);
+
+/*
+  Removes a number from the set if it lies in the window
+*/
+BaseErrorCode removeWindowBitSetElement(const WindowBitSet *windowBitSet,
+                                        uint64_t element);
+
+/*
+  Checks if there is an element in the set
+*/
+bool isWindowBitSetContains(const WindowBitSet *windowBitSet,
+                            uint64_t element);
+
+/*
+  Creates a set with the meaning А ∪ В over the window covering both sets.
+  The cover takes one bit per number between the lowest and the highest
+  bound, the gap between the windows included. If the gap is wider than
+  both windows together, no set is created and its bits are NULL
+*/
+WindowBitSet getWindowBitSetsUnion(const WindowBitSet *windowBitSetA,
+                                   const WindowBitSet *windowBitSetB);
+
+/*
+  Creates a set with the meaning А ∩ В over the overlap of the windows.
+  If the windows do not overlap, the result has no elements
+*/
+WindowBitSet getWindowBitSetsIntersection(const WindowBitSet *windowBitSetA,
+                                          const WindowBitSet *windowBitSetB);
+
+/*
+  Creates a set with the meaning А - В over the window of A
+*/
+WindowBitSet getWindowBitSetsDiff(const WindowBitSet *windowBitSetA,
+                                  const WindowBitSet *windowBitSetB);
+
+/*
+  Creates a set with the meaning А △ В over the window covering both sets.
+  The cover costs and limits are the same as for the union
+*/
+WindowBitSet getSymmetricWindowBitSetsDiff(const WindowBitSet *windowBitSetA,
+                                           const WindowBitSet *windowBitSetB);
+
+#endif
@@ -1,9 +1,22 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <time.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "../src/bitset/bitset.h"
+#include "../src/bloom/bloom.h"
+#include "../src/delta/delta.h"
+#include "../src/fixed/fixed_bitset.h"
+#include "../src/ingest/ingest.h"
+#include "../src/intern/intern.h"
+#include "../src/iterator/iterator.h"
+#include "../src/journal/journal.h"
+#include "../src/shared/shared.h"
+#include "../src/window/window.h"
 #include "../src/errors/errors.h"
 #include "../src/output/output.h"
 
@@ -77,6 +90,8 @@ void testRemove() {
     destroyBitSet(&set);
 }
 
+DEFINE_FIXED_BITSET(FlagSet, 11)
+
 void testPerformance() {
     const size_t N = 1000000;
     BitSet set = createBitSet(N);
@@ -485,6 +500,1213 @@ void testSymmetricDiff() {
     }
 }
 
+void testSummary() {
+    const size_t N = 100000;
+
+    BitSet set1 = createBitSet(N);
+    BitSet set2 = createBitSet(N);
+    BitSet plainSet1 = createBitSet(N);
+    BitSet plainSet2 = createBitSet(N);
+
+    bool isCorrect = true;
+
+    enableBitSetSummary(&set1);
+    enableBitSetSummary(&set2);
+
+    isCorrect &= isBitSetEmpty(&set1);
+
+    for (size_t iter = 5000; iter < 5200; iter++) {
+        addBitSetElement(&set1, iter);
+        addBitSetElement(&plainSet1, iter);
+    }
+    for (size_t iter = 5100; iter < 90000; iter += 777) {
+        addBitSetElement(&set2, iter);
+        addBitSetElement(&plainSet2, iter);
+    }
+    for (size_t iter = 5000; iter < 5064; iter++) {
+        removeBitSetElement(&set1, iter);
+        removeBitSetElement(&plainSet1, iter);
+    }
+
+    isCorrect &= !isBitSetEmpty(&set1);
+    // Only blocks 79, 80 and 81 remain non-empty
+    isCorrect &= set1.summary[0] == 0;
+    isCorrect &= set1.summary[1] == 7ULL << (63 - 81 % 64);
+
+    BitSet result = getBitSetsUnion(&set1, &set2);
+    BitSet expected = getBitSetsUnion(&plainSet1, &plainSet2);
+    isCorrect &= isBitSetsEqual(&result, &expected);
+    destroyBitSet(&result);
+    destroyBitSet(&expected);
+
+    result = getBitSetsIntersection(&set1, &set2);
+    expected = getBitSetsIntersection(&plainSet1, &plainSet2);
+    isCorrect &= isBitSetsEqual(&result, &expected);
+    isCorrect &= isSubset(&result, &set1);
+    destroyBitSet(&result);
+    destroyBitSet(&expected);
+
+    result = getBitSetsDiff(&set2, &set1);
+    expected = getBitSetsDiff(&plainSet2, &plainSet1);
+    isCorrect &= isBitSetsEqual(&result, &expected);
+    destroyBitSet(&result);
+    destroyBitSet(&expected);
+
+    for (size_t iter = 5064; iter < 5200; iter++) {
+        removeBitSetElement(&set1, iter);
+    }
+    isCorrect &= isBitSetEmpty(&set1);
+
+    assertWithMessage(isCorrect, getTestErrorMessage(SUMMARY_TEST_ERROR));
+
+    destroyBitSet(&set1);
+    destroyBitSet(&set2);
+    destroyBitSet(&plainSet1);
+    destroyBitSet(&plainSet2);
+}
+
+void testFind() {
+    BitSet set = createBitSet(200);
+
+    bool isCorrect = true;
+    uint64_t element = 0;
+
+    isCorrect &= findFirstBitSetElement(&set, &element) == ELEMENT_NOT_FOUND_ERROR;
+
+    for (size_t iter = 0; iter < 130; iter++) {
+        addBitSetElement(&set, iter);
+    }
+    removeBitSetElement(&set, 70);
+    removeBitSetElement(&set, 0);
+
+    isCorrect &= findFirstBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == 1;
+    isCorrect &= findFirstBitSetFreeElement(&set, &element) == NONE_ERROR &&
+                 element == 0;
+    isCorrect &= findNextBitSetFreeElement(&set, 1, &element) == NONE_ERROR &&
+                 element == 70;
+    isCorrect &= findNextBitSetFreeElement(&set, 71, &element) == NONE_ERROR &&
+                 element == 130;
+
+    for (size_t iter = 130; iter <= 200; iter++) {
+        addBitSetElement(&set, iter);
+    }
+    isCorrect &= findNextBitSetFreeElement(&set, 71, &element) == NONE_ERROR &&
+                 element == 0;
+
+    addBitSetElement(&set, 0);
+    addBitSetElement(&set, 70);
+    isCorrect &= findFirstBitSetFreeElement(&set, &element) ==
+                 ELEMENT_NOT_FOUND_ERROR;
+
+    assertWithMessage(isCorrect, getTestErrorMessage(FIND_TEST_ERROR));
+
+    destroyBitSet(&set);
+}
+
+void testAllocate() {
+    BitSet set = createBitSet(127);
+
+    bool isCorrect = true;
+    uint64_t element = 0;
+
+    enableBitSetSummary(&set);
+
+    for (uint64_t iter = 0; iter < 100; iter++) {
+        isCorrect &= allocateBitSetElement(&set, &element) == NONE_ERROR &&
+                     element == iter;
+    }
+
+    removeBitSetElement(&set, 10);
+    removeBitSetElement(&set, 11);
+    removeBitSetElement(&set, 50);
+
+    isCorrect &= allocateBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == 10;
+
+    // Only 11 and 50 are free before 100, so the run starts at 100
+    isCorrect &= allocateBitSetRange(&set, 2, &element) == NONE_ERROR &&
+                 element == 100;
+    isCorrect &= allocateBitSetRange(&set, 26, &element) == NONE_ERROR &&
+                 element == 102;
+    isCorrect &= allocateBitSetRange(&set, 2, &element) ==
+                 ELEMENT_NOT_FOUND_ERROR;
+    isCorrect &= allocateBitSetRange(&set, 1, &element) == NONE_ERROR &&
+                 element == 11;
+    isCorrect &= isBitSetContains(&set, 127) && !isBitSetContains(&set, 50);
+
+    removeBitSetElement(&set, 120);
+
+    isCorrect &= allocateNextBitSetElement(&set, 60, &element) == NONE_ERROR &&
+                 element == 120;
+    isCorrect &= allocateNextBitSetElement(&set, element + 1, &element) ==
+                     NONE_ERROR &&
+                 element == 50;
+    isCorrect &= allocateNextBitSetElement(&set, element + 1, &element) ==
+                 ELEMENT_NOT_FOUND_ERROR;
+
+    assertWithMessage(isCorrect, getTestErrorMessage(ALLOCATION_TEST_ERROR));
+
+    destroyBitSet(&set);
+}
+
+void testIngest() {
+    const char text[] = "5, 17\n300,abc 64\n\n18446744073709551616,1000 3";
+    const uint8_t binary[20] = {7, 0, 0, 0, 0, 0, 0, 0,
+                                0, 1, 0, 0, 0, 0, 0, 0,
+                                1, 2, 3, 4};
+
+    bool isCorrect = true;
+    IngestStats stats;
+
+    {
+        BitSet set = createBitSet(500);
+        BitSet expectedSet = createBitSet(500);
+        uint64_t expectedValues[5] = {3, 5, 17, 64, 300};
+        addManyBitSetElements(&expectedSet, 5, expectedValues);
+
+        ingestBitSetFromText(&set, text, sizeof(text) - 1, &stats);
+        isCorrect &= isBitSetsEqual(&set, &expectedSet);
+        isCorrect &= stats.accepted == 5 && stats.rejected == 3;
+
+        destroyBitSet(&set);
+        set = createBitSet(500);
+
+        ingestBitSetFromTextParallel(&set, text, sizeof(text) - 1, 4, &stats);
+        isCorrect &= isBitSetsEqual(&set, &expectedSet);
+        isCorrect &= stats.accepted == 5 && stats.rejected == 3;
+
+        destroyBitSet(&set);
+        destroyBitSet(&expectedSet);
+    }
+
+    {
+        BitSet set = createBitSet(500);
+
+        ingestBitSetFromBinary(&set, binary, sizeof(binary), &stats);
+        isCorrect &= isBitSetContains(&set, 7) && isBitSetContains(&set, 256);
+        isCorrect &= stats.accepted == 2 && stats.rejected == 1;
+
+        destroyBitSet(&set);
+    }
+
+    {
+        BitSet set = createBitSet(500);
+        FILE *file = tmpfile();
+
+        fputs(text, file);
+        fflush(file);
+        rewind(file);
+
+        ingestBitSetFromTextFile(&set, fileno(file), &stats);
+        isCorrect &= isBitSetContains(&set, 300) && isBitSetContains(&set, 3);
+        isCorrect &= stats.accepted == 5 && stats.rejected == 3;
+
+        fclose(file);
+        destroyBitSet(&set);
+    }
+
+    {
+        // Enough numbers for every thread to fill several blocks
+        const size_t N = 20000;
+        char *longText = malloc(N * 8 + 1);
+        size_t length = 0;
+        BitSet set = createBitSet(N);
+        BitSet expectedSet = createBitSet(N);
+
+        for (size_t iter = 0; longText != NULL && iter < N; iter++) {
+            length += (size_t)sprintf(longText + length, "%zu%s",
+                                      (iter * 7919) % (N + 100),
+                                      iter % 50 == 0 ? " x\n" : ",");
+        }
+
+        ingestBitSetFromText(&expectedSet, longText, length, &stats);
+        const IngestStats expectedStats = stats;
+        ingestBitSetFromTextParallel(&set, longText, length, 4, &stats);
+
+        isCorrect &= longText != NULL && isBitSetsEqual(&set, &expectedSet);
+        isCorrect &= stats.accepted == expectedStats.accepted &&
+                     stats.rejected == expectedStats.rejected;
+
+        free(longText);
+        destroyBitSet(&set);
+        destroyBitSet(&expectedSet);
+    }
+
+    assertWithMessage(isCorrect, getTestErrorMessage(INGEST_TEST_ERROR));
+}
+
+void testHash() {
+    const size_t N = 1000;
+
+    BitSet set1 = createBitSet(N);
+    BitSet set2 = createBitSet(N);
+    BitSet biggerSet = createBitSet(N + 1);
+
+    bool isCorrect = true;
+
+    uint64_t values[6] = {0, 63, 64, 500, 777, 1000};
+    addManyBitSetElements(&set1, 6, values);
+    addManyBitSetElements(&set2, 6, values);
+    addManyBitSetElements(&biggerSet, 6, values);
+    enableBitSetSummary(&set2);
+
+    isCorrect &= getBitSetHash(&set1) == getBitSetHash(&set2);
+    isCorrect &= getBitSetHash(&set1) != getBitSetHash(&biggerSet);
+    isCorrect &= !isBitSetsEqual(&set1, &biggerSet);
+
+    removeBitSetElement(&set2, 1000);
+    isCorrect &= getBitSetHash(&set1) != getBitSetHash(&set2);
+    isCorrect &= !isBitSetsEqual(&set1, &set2);
+
+    assertWithMessage(isCorrect, getTestErrorMessage(HASH_TEST_ERROR));
+
+    destroyBitSet(&set1);
+    destroyBitSet(&set2);
+    destroyBitSet(&biggerSet);
+}
+
+void testIntern() {
+    const size_t N = 300;
+
+    BitSetInternTable table = createBitSetInternTable();
+    BitSet sets[40];
+    const BitSet *canonicals[40];
+
+    bool isCorrect = true;
+
+    for (size_t iter = 0; iter < 40; iter++) {
+        sets[iter] = createBitSet(N);
+        addBitSetElement(&sets[iter], iter % 20);
+        addBitSetElement(&sets[iter], 250);
+        internBitSet(&table, &sets[iter], &canonicals[iter]);
+    }
+
+    isCorrect &= table.count == 20;
+    for (size_t iter = 0; iter < 20; iter++) {
+        isCorrect &= canonicals[iter] == canonicals[iter + 20];
+        isCorrect &= canonicals[iter] != canonicals[(iter + 1) % 20];
+        isCorrect &= isBitSetsEqual(canonicals[iter], &sets[iter]);
+    }
+
+    releaseInternedBitSet(&table, canonicals[0]);
+    isCorrect &= table.count == 20;
+    releaseInternedBitSet(&table, canonicals[20]);
+    isCorrect &= table.count == 19;
+
+    // A removed table looks like one which failed to be created
+    destroyBitSetInternTable(&table);
+    isCorrect &= internBitSet(&table, &sets[0], &canonicals[0]) ==
+                 MEMORY_ALLOCATION_ERROR;
+    isCorrect &= releaseInternedBitSet(&table, &sets[0]) ==
+                 MEMORY_ALLOCATION_ERROR;
+
+    assertWithMessage(isCorrect, getTestErrorMessage(INTERN_TEST_ERROR));
+
+    for (size_t iter = 0; iter < 40; iter++) {
+        destroyBitSet(&sets[iter]);
+    }
+}
+
+void testDelta() {
+    const size_t N = 100000;
+
+    BitSet version1 = createBitSet(N);
+    BitSet version2 = createBitSet(N);
+    BitSet version3 = createBitSet(N);
+
+    bool isCorrect = true;
+
+    for (size_t iter = 0; iter < N; iter += 3) {
+        addBitSetElement(&version1, iter);
+        addBitSetElement(&version2, iter);
+        addBitSetElement(&version3, iter);
+    }
+    removeBitSetElement(&version2, 3);
+    addBitSetElement(&version2, 50000);
+    addBitSetElement(&version2, 99999);
+    addBitSetElement(&version3, 50000);
+    addBitSetElement(&version3, 70001);
+    enableBitSetSummary(&version3);
+
+    BitSetDelta delta1;
+    BitSetDelta delta2;
+    BitSetDelta chainedDelta;
+
+    isCorrect &= createBitSetDelta(&version1, &version2, &delta1) == NONE_ERROR;
+    isCorrect &= createBitSetDelta(&version2, &version3, &delta2) == NONE_ERROR;
+    isCorrect &= chainBitSetDeltas(&delta1, &delta2, &chainedDelta) == NONE_ERROR;
+    isCorrect &= delta1.length < 32;
+
+    {
+        // One changed low element per block costs a short varint
+        BitSet sparseSet = createBitSet(N);
+        BitSetDelta sparseDelta;
+
+        for (size_t iter = 0; iter < N; iter += 64 * 16) {
+            addBitSetElement(&sparseSet, iter);
+        }
+        BitSet emptySet = createBitSet(N);
+        isCorrect &= createBitSetDelta(&emptySet, &sparseSet, &sparseDelta) ==
+                     NONE_ERROR;
+        isCorrect &= sparseDelta.length <= 4 + 2 * (N / (64 * 16) + 1);
+
+        BitSetDelta deltaFromEmpty;
+        isCorrect &= createBitSetDeltaFromEmpty(&sparseSet, &deltaFromEmpty) ==
+                     NONE_ERROR;
+        isCorrect &= deltaFromEmpty.length == sparseDelta.length &&
+                     memcmp(deltaFromEmpty.data, sparseDelta.data,
+                            sparseDelta.length) == 0;
+        destroyBitSetDelta(&deltaFromEmpty);
+
+        isCorrect &= applyBitSetDelta(&emptySet, &sparseDelta) == NONE_ERROR &&
+                     isBitSetsEqual(&emptySet, &sparseSet);
+
+        destroyBitSetDelta(&sparseDelta);
+        destroyBitSet(&emptySet);
+        destroyBitSet(&sparseSet);
+    }
+
+    BitSet replica = copyBitSet(&version1);
+    isCorrect &= applyBitSetDelta(&replica, &delta1) == NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&replica, &version2);
+    isCorrect &= applyBitSetDelta(&replica, &delta2) == NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&replica, &version3);
+    destroyBitSet(&replica);
+
+    replica = copyBitSet(&version1);
+    isCorrect &= applyBitSetDelta(&replica, &chainedDelta) == NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&replica, &version3);
+
+    // Truncated delta is rejected without touching the set
+    chainedDelta.length--;
+    isCorrect &= applyBitSetDelta(&replica, &chainedDelta) ==
+                 INVALID_ARGUMENT_ERROR;
+    isCorrect &= isBitSetsEqual(&replica, &version3);
+    destroyBitSet(&replica);
+
+    {
+        // A gap wrapping the position back to block 0 is rejected
+        uint8_t wrappingData[16] = {0x40, 0x00, 0x01, 0xFF, 0xFF, 0xFF,
+                                    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                    0x01, 0x01};
+        const BitSetDelta wrappingDelta = {wrappingData, 14};
+        BitSet smallSet = createBitSet(64);
+        BitSetDelta wrappedDelta;
+
+        isCorrect &= applyBitSetDelta(&smallSet, &wrappingDelta) ==
+                     INVALID_ARGUMENT_ERROR;
+        isCorrect &= isBitSetEmpty(&smallSet);
+        isCorrect &= chainBitSetDeltas(&wrappingDelta, &wrappingDelta,
+                                       &wrappedDelta) == INVALID_ARGUMENT_ERROR;
+
+        // The same delta without the wrapping entry is fine
+        const BitSetDelta validDelta = {wrappingData, 3};
+        isCorrect &= applyBitSetDelta(&smallSet, &validDelta) == NONE_ERROR &&
+                     isBitSetContains(&smallSet, 0);
+
+        destroyBitSet(&smallSet);
+    }
+
+    assertWithMessage(isCorrect, getTestErrorMessage(DELTA_TEST_ERROR));
+
+    destroyBitSetDelta(&delta1);
+    destroyBitSetDelta(&delta2);
+    destroyBitSetDelta(&chainedDelta);
+    destroyBitSet(&version1);
+    destroyBitSet(&version2);
+    destroyBitSet(&version3);
+}
+
+void testFixedBitSet() {
+    bool isCorrect = true;
+
+    {
+        FlagSet set1 = createFlagSet();
+        FlagSet set2 = createFlagSet();
+
+        uint64_t values1[4] = {1, 2, 4, 9};
+        uint64_t values2[5] = {2, 3, 4, 5, 10};
+        for (size_t iter = 0; iter < 4; iter++) {
+            addFlagSetElement(&set1, values1[iter]);
+        }
+        for (size_t iter = 0; iter < 5; iter++) {
+            addFlagSetElement(&set2, values2[iter]);
+        }
+
+        isCorrect &= addFlagSetElement(&set1, 11) == CAPACITY_EXCEEDING_ERROR;
+
+        BitSet dynamicSet1 = getFlagSetAsBitSet(&set1);
+        BitSet dynamicSet2 = getFlagSetAsBitSet(&set2);
+        BitSet expectedSet = getSymmetricBitSetsDiff(&dynamicSet1, &dynamicSet2);
+        BitSet expectedComplement = getBitSetComplement(&dynamicSet1);
+
+        FlagSet result = getSymmetricFlagSetsDiff(&set1, &set2);
+        BitSet dynamicResult = getFlagSetAsBitSet(&result);
+        isCorrect &= isBitSetsEqual(&dynamicResult, &expectedSet);
+        destroyBitSet(&dynamicResult);
+
+        result = getFlagSetComplement(&set1);
+        dynamicResult = getFlagSetAsBitSet(&result);
+        isCorrect &= isBitSetsEqual(&dynamicResult, &expectedComplement);
+        destroyBitSet(&dynamicResult);
+
+        result = getFlagSetsIntersection(&set1, &set2);
+        isCorrect &= isFlagSetSubset(&result, &set1);
+        isCorrect &= isFlagSetContains(&result, 4) && !isFlagSetContains(&result, 9);
+
+        destroyBitSet(&dynamicSet1);
+        destroyBitSet(&dynamicSet2);
+        destroyBitSet(&expectedSet);
+        destroyBitSet(&expectedComplement);
+    }
+
+    {
+        BitSet dynamicSet = createBitSet(200);
+        BitSet128 set = createBitSet128();
+
+        addBitSetElement(&dynamicSet, 127);
+        isCorrect &= setBitSet128FromBitSet(&set, &dynamicSet) == NONE_ERROR;
+        isCorrect &= isBitSet128Contains(&set, 127);
+
+        addBitSetElement(&dynamicSet, 128);
+        isCorrect &= setBitSet128FromBitSet(&set, &dynamicSet) ==
+                     CAPACITY_EXCEEDING_ERROR;
+
+        removeBitSet128Element(&set, 127);
+        isCorrect &= isBitSet128Empty(&set);
+
+        destroyBitSet(&dynamicSet);
+    }
+
+    assertWithMessage(isCorrect, getTestErrorMessage(FIXED_BITSET_TEST_ERROR));
+}
+
+void testWindow() {
+    const uint64_t base = 1000000000000ULL;
+
+    WindowBitSet set1 = createWindowBitSet(base, base + 1000);
+    WindowBitSet set2 = createWindowBitSet(base + 600, base + 2000);
+    WindowBitSet alignedSet = createWindowBitSet(base + 640, base + 700);
+
+    bool isCorrect = true;
+
+    isCorrect &= addWindowBitSetElement(&set1, base - 1) ==
+                 CAPACITY_EXCEEDING_ERROR;
+    isCorrect &= addWindowBitSetElement(&set1, base + 1000) ==
+                 CAPACITY_EXCEEDING_ERROR;
+
+    uint64_t values1[6] = {0, 5, 600, 650, 700, 999};
+    uint64_t values2[5] = {600, 700, 701, 1500, 1999};
+    for (size_t iter = 0; iter < 6; iter++) {
+        addWindowBitSetElement(&set1, base + values1[iter]);
+    }
+    for (size_t iter = 0; iter < 5; iter++) {
+        addWindowBitSetElement(&set2, base + values2[iter]);
+    }
+    addWindowBitSetElement(&alignedSet, base + 650);
+
+    WindowBitSet result = getWindowBitSetsIntersection(&set1, &set2);
+    isCorrect &= result.base == base + 600 &&
+                 getWindowBitSetEnd(&result) == base + 1000;
+    isCorrect &= isWindowBitSetContains(&result, base + 600) &&
+                 isWindowBitSetContains(&result, base + 700) &&
+                 !isWindowBitSetContains(&result, base + 650);
+    destroyWindowBitSet(&result);
+
+    result = getWindowBitSetsUnion(&set1, &set2);
+    for (size_t iter = 0; iter < 6; iter++) {
+        isCorrect &= isWindowBitSetContains(&result, base + values1[iter]);
+    }
+    for (size_t iter = 0; iter < 5; iter++) {
+        isCorrect &= isWindowBitSetContains(&result, base + values2[iter]);
+    }
+    isCorrect &= !isWindowBitSetContains(&result, base + 6);
+    destroyWindowBitSet(&result);
+
+    result = getSymmetricWindowBitSetsDiff(&set1, &set2);
+    isCorrect &= isWindowBitSetContains(&result, base + 701) &&
+                 isWindowBitSetContains(&result, base + 650) &&
+                 !isWindowBitSetContains(&result, base + 600);
+    destroyWindowBitSet(&result);
+
+    result = getWindowBitSetsDiff(&set1, &alignedSet);
+    isCorrect &= !isWindowBitSetContains(&result, base + 650) &&
+                 isWindowBitSetContains(&result, base + 600) &&
+                 isWindowBitSetContains(&result, base + 999);
+    destroyWindowBitSet(&result);
+
+    WindowBitSet distantSet = createWindowBitSet(0, 10);
+    addWindowBitSetElement(&distantSet, 5);
+    result = getWindowBitSetsIntersection(&alignedSet, &distantSet);
+    isCorrect &= isBitSetEmpty(&result.bitSet);
+    destroyWindowBitSet(&result);
+
+    // The cover of two small windows far apart would be mostly gap
+    result = getWindowBitSetsUnion(&alignedSet, &distantSet);
+    isCorrect &= result.bitSet.bits == NULL;
+    destroyWindowBitSet(&result);
+    result = getSymmetricWindowBitSetsDiff(&distantSet, &alignedSet);
+    isCorrect &= result.bitSet.bits == NULL;
+    destroyWindowBitSet(&result);
+    destroyWindowBitSet(&distantSet);
+
+    assertWithMessage(isCorrect, getTestErrorMessage(WINDOW_TEST_ERROR));
+
+    destroyWindowBitSet(&set1);
+    destroyWindowBitSet(&set2);
+    destroyWindowBitSet(&alignedSet);
+}
+
+void testShift() {
+    const size_t N = 200;
+
+    bool isCorrect = true;
+
+    uint64_t values[6] = {0, 1, 63, 64, 130, 200};
+    int64_t offsets[7] = {0, 1, 5, 64, 70, -3, -130};
+
+    for (size_t iter = 0; iter < 7; iter++) {
+        const int64_t offset = offsets[iter];
+
+        BitSet set = createBitSet(N);
+        BitSet expectedShifted = createBitSet(N);
+        BitSet expectedRotated = createBitSet(N);
+
+        addManyBitSetElements(&set, 6, values);
+        enableBitSetSummary(&set);
+
+        for (size_t valuePos = 0; valuePos < 6; valuePos++) {
+            const int64_t moved = (int64_t)values[valuePos] + offset;
+            if (moved >= 0) {
+                addBitSetElement(&expectedShifted, (uint64_t)moved);
+            }
+            addBitSetElement(&expectedRotated,
+                             (uint64_t)((moved + N + 1) % (N + 1)));
+        }
+
+        BitSet result = getShiftedBitSet(&set, offset);
+        isCorrect &= isBitSetsEqual(&result, &expectedShifted);
+        destroyBitSet(&result);
+
+        result = getRotatedBitSet(&set, offset);
+        isCorrect &= isBitSetsEqual(&result, &expectedRotated);
+        destroyBitSet(&result);
+
+        result = createBitSet(N);
+        enableBitSetSummary(&result);
+        isCorrect &= rotateBitSetInto(&set, offset, &result) == NONE_ERROR;
+        isCorrect &= isBitSetsEqual(&result, &expectedRotated);
+        isCorrect &= shiftBitSetInto(&set, offset, &result) == NONE_ERROR;
+        isCorrect &= isBitSetsEqual(&result, &expectedShifted);
+        isCorrect &= rotateBitSetInto(&set, offset, &set) != NONE_ERROR;
+        destroyBitSet(&result);
+
+        rotateBitSet(&set, offset);
+        isCorrect &= isBitSetsEqual(&set, &expectedRotated);
+        rotateBitSet(&set, -offset);
+
+        shiftBitSet(&set, offset);
+        isCorrect &= isBitSetsEqual(&set, &expectedShifted);
+        isCorrect &= isBitSetEmpty(&set) == isBitSetEmpty(&expectedShifted);
+
+        destroyBitSet(&set);
+        destroyBitSet(&expectedShifted);
+        destroyBitSet(&expectedRotated);
+    }
+
+    // Dense sets exercise the word swaps of the in-place rotation
+    for (int64_t offset = -700; offset <= 700; offset += 97) {
+        const size_t M = 1000;
+
+        BitSet set = createBitSet(M);
+        BitSet expectedRotated = createBitSet(M);
+
+        for (uint64_t value = 0; value <= M; value++) {
+            if (value % 3 == 0 || value % 7 == 0) {
+                addBitSetElement(&set, value);
+                addBitSetElement(
+                    &expectedRotated,
+                    (uint64_t)(((int64_t)value + offset + 2 * (M + 1)) %
+                               (int64_t)(M + 1)));
+            }
+        }
+
+        rotateBitSet(&set, offset);
+        isCorrect &= isBitSetsEqual(&set, &expectedRotated);
+
+        destroyBitSet(&set);
+        destroyBitSet(&expectedRotated);
+    }
+
+    assertWithMessage(isCorrect, getTestErrorMessage(SHIFT_TEST_ERROR));
+}
+
+void testBloomFilter() {
+    const size_t N = 2000;
+
+    BloomFilter filter1 = createBloomFilter(N * 10, 7);
+    BloomFilter filter2 = createBloomFilter(N * 10, 7);
+
+    bool isCorrect = true;
+
+    uint64_t keys[2000];
+    bool results[2000];
+    for (size_t iter = 0; iter < N; iter++) {
+        keys[iter] = iter * 1000003ULL;
+    }
+
+    // Lines must not straddle cache lines
+    isCorrect &= (uintptr_t)filter1.bitSet.bits % BLOOM_LINE_BYTES == 0;
+
+    addManyBloomFilterKeys(&filter1, N / 2, keys);
+    for (size_t iter = N / 2; iter < N; iter++) {
+        addBloomFilterKey(&filter2, keys[iter]);
+    }
+
+    queryManyBloomFilterKeys(&filter1, N / 2, keys, results);
+    for (size_t iter = 0; iter < N / 2; iter++) {
+        isCorrect &= results[iter];
+    }
+
+    size_t falsePositives = 0;
+    for (size_t iter = 0; iter < 10000; iter++) {
+        falsePositives += isBloomFilterContains(&filter1, iter * 7 + 1);
+    }
+    isCorrect &= falsePositives < 200;
+
+    const double estimate = estimateBloomFilterCount(&filter1);
+    isCorrect &= estimate > N / 2 * 0.9 && estimate < N / 2 * 1.1;
+
+    BloomFilter unionFilter;
+    isCorrect &= getBloomFiltersUnion(&filter1, &filter2, &unionFilter) ==
+                 NONE_ERROR;
+    isCorrect &= (uintptr_t)unionFilter.bitSet.bits % BLOOM_LINE_BYTES == 0;
+    queryManyBloomFilterKeys(&unionFilter, N, keys, results);
+    for (size_t iter = 0; iter < N; iter++) {
+        isCorrect &= results[iter];
+    }
+
+    uint8_t *data = NULL;
+    size_t length = 0;
+    BloomFilter restoredFilter;
+    serializeBloomFilter(&unionFilter, &data, &length);
+    isCorrect &= deserializeBloomFilter(data, length, &restoredFilter) ==
+                 NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&restoredFilter.bitSet, &unionFilter.bitSet);
+    isCorrect &= deserializeBloomFilter(data, length - 1, &filter2) ==
+                 INVALID_ARGUMENT_ERROR;
+
+    // A hash count of 2^63 would make every later lookup endless
+    data[2 * sizeof(uint64_t) - 1] = 0x80;
+    isCorrect &= deserializeBloomFilter(data, length, &filter2) ==
+                 INVALID_ARGUMENT_ERROR;
+
+    assertWithMessage(isCorrect, getTestErrorMessage(BLOOM_FILTER_TEST_ERROR));
+
+    free(data);
+    destroyBloomFilter(&filter1);
+    destroyBloomFilter(&filter2);
+    destroyBloomFilter(&unionFilter);
+    destroyBloomFilter(&restoredFilter);
+}
+
+void testJournal() {
+    const size_t N = 10000;
+
+    // Every run works in its own directory, so parallel runs do not collide
+    char directory[] = "/tmp/bitset_journal_XXXXXX";
+    char journalPath[sizeof(directory) + 16];
+    char checkpointPath[sizeof(directory) + 16];
+
+    bool isCorrect = mkdtemp(directory) != NULL;
+    snprintf(journalPath, sizeof(journalPath), "%s/journal", directory);
+    snprintf(checkpointPath, sizeof(checkpointPath), "%s/checkpoint",
+             directory);
+
+    BitSet set = createBitSet(N);
+    BitSet recoveredSet;
+    BitSetJournal journal;
+
+    isCorrect &= openBitSetJournal(&journal, journalPath, N, 4) == NONE_ERROR;
+    journalAddBitSetElement(&journal, &set, 5);
+    journalAddBitSetRange(&journal, &set, 100, 300);
+    journalRemoveBitSetElement(&journal, &set, 150);
+    isCorrect &= journalAddBitSetElement(&journal, &set, N + 1) ==
+                 CAPACITY_EXCEEDING_ERROR;
+    journalAddBitSetElement(&journal, &set, 9999);
+    commitBitSetJournal(&journal);
+
+    isCorrect &= recoverBitSet(journalPath, checkpointPath, &recoveredSet) ==
+                 NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&recoveredSet, &set);
+    destroyBitSet(&recoveredSet);
+
+    // A change whose group commit fails is not applied to the set
+    const int journalFd = dup(journal.fd);
+    close(journal.fd);
+    journalAddBitSetElement(&journal, &set, 10);
+    journalAddBitSetElement(&journal, &set, 11);
+    journalAddBitSetElement(&journal, &set, 12);
+    isCorrect &= journalAddBitSetElement(&journal, &set, 13) ==
+                 FILE_WRITE_ERROR;
+    isCorrect &= isBitSetContains(&set, 12) && !isBitSetContains(&set, 13);
+    isCorrect &= commitBitSetJournal(&journal) == FILE_WRITE_ERROR;
+
+    dup2(journalFd, journal.fd);
+    close(journalFd);
+    isCorrect &= commitBitSetJournal(&journal) == NONE_ERROR;
+
+    isCorrect &= recoverBitSet(journalPath, checkpointPath, &recoveredSet) ==
+                 NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&recoveredSet, &set);
+    destroyBitSet(&recoveredSet);
+
+    isCorrect &= checkpointBitSetJournal(&journal, &set, checkpointPath) ==
+                 NONE_ERROR;
+    journalRemoveBitSetRange(&journal, &set, 0, 200);
+    journalAddBitSetElement(&journal, &set, 7000);
+    closeBitSetJournal(&journal);
+
+    isCorrect &= recoverBitSet(journalPath, checkpointPath, &recoveredSet) ==
+                 NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&recoveredSet, &set);
+    destroyBitSet(&recoveredSet);
+
+    // Reopening with another capacity is refused
+    isCorrect &= openBitSetJournal(&journal, journalPath, N + 1, 4) ==
+                 INVALID_ARGUMENT_ERROR;
+
+    // A dense set goes to a full checkpoint
+    isCorrect &= openBitSetJournal(&journal, journalPath, N, 1000) == NONE_ERROR;
+    journalAddBitSetRange(&journal, &set, 0, N + 1);
+    checkpointBitSetJournal(&journal, &set, checkpointPath);
+    closeBitSetJournal(&journal);
+
+    isCorrect &= recoverBitSet(journalPath, checkpointPath, &recoveredSet) ==
+                 NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&recoveredSet, &set);
+    destroyBitSet(&recoveredSet);
+
+    // The files are removed before the check, which stops a failed run
+    remove(journalPath);
+    remove(checkpointPath);
+    strcat(checkpointPath, ".tmp");
+    remove(checkpointPath);
+    remove(directory);
+    destroyBitSet(&set);
+
+    assertWithMessage(isCorrect, getTestErrorMessage(JOURNAL_TEST_ERROR));
+}
+
+void testBulkBuild() {
+    const size_t N = 100000;
+    const size_t count = 50000;
+
+    BitSet set = createBitSet(N);
+    BitSet expectedSet = createBitSet(N);
+    uint64_t *elements = malloc(count * sizeof(uint64_t));
+
+    bool isCorrect = elements != NULL;
+    IngestStats stats;
+
+    for (size_t iter = 0; isCorrect && iter < count; iter++) {
+        // Every hundredth element is out of the capacity
+        elements[iter] = iter % 100 == 0 ? N + 1 + iter
+                                         : (iter * 7919) % (N + 1);
+        addBitSetElement(&expectedSet, elements[iter]);
+    }
+
+    enableBitSetSummary(&set);
+    isCorrect &= buildBitSetFromElements(&set, count, elements, 4, &stats) ==
+                 NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&set, &expectedSet);
+    isCorrect &= stats.accepted == count - count / 100 &&
+                 stats.rejected == count / 100;
+
+    // The summary filled by the threads matches a rebuilt one
+    enableBitSetSummary(&expectedSet);
+    for (size_t wordPos = 0; wordPos < getBitSetSummarySize(&set); wordPos++) {
+        isCorrect &= getBitSetSummaryWord(&set, wordPos) ==
+                     getBitSetSummaryWord(&expectedSet, wordPos);
+    }
+
+    destroyBitSet(&set);
+    set = createBitSet(N);
+
+    isCorrect &= buildBitSetFromElements(&set, count, elements, 1, &stats) ==
+                 NONE_ERROR;
+    isCorrect &= isBitSetsEqual(&set, &expectedSet);
+    isCorrect &= stats.rejected == count / 100;
+
+    // The active range covers what every partition filled
+    const uint64_t sparse[] = {N, 70, 99000, 3000};
+    uint64_t element = 0;
+    destroyBitSet(&set);
+    set = createBitSet(N);
+    enableBitSetActiveRange(&set);
+
+    isCorrect &= buildBitSetFromElements(&set, 4, sparse, 4, &stats) ==
+                 NONE_ERROR;
+    isCorrect &= findFirstBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == 70;
+    isCorrect &= findLastBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == N;
+    isCorrect &= getBitSetCount(&set) == 4 && isBitSetContains(&set, 3000);
+
+    assertWithMessage(isCorrect, getTestErrorMessage(BULK_BUILD_TEST_ERROR));
+
+    free(elements);
+    destroyBitSet(&set);
+    destroyBitSet(&expectedSet);
+}
+
+void testActiveRange() {
+    const size_t N = 100000;
+
+    BitSet set = createBitSet(N);
+    BitSet otherSet = createBitSet(N);
+    uint64_t element = 0;
+
+    bool isCorrect = true;
+
+    enableBitSetActiveRange(&set);
+    isCorrect &= findFirstBitSetElement(&set, &element) ==
+                 ELEMENT_NOT_FOUND_ERROR;
+    isCorrect &= findLastBitSetElement(&set, &element) ==
+                 ELEMENT_NOT_FOUND_ERROR;
+
+    addBitSetElement(&set, 50000);
+    addBitSetElement(&set, 50100);
+    addBitSetRange(&set, 60000, 60010);
+    isCorrect &= findFirstBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == 50000;
+    isCorrect &= findLastBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == 60009;
+
+    // Removing the bounds moves them on the next query
+    removeBitSetElement(&set, 50000);
+    removeBitSetRange(&set, 60000, 60010);
+    isCorrect &= findFirstBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == 50100;
+    isCorrect &= findLastBitSetElement(&set, &element) == NONE_ERROR &&
+                 element == 50100;
+
+    // Operations on tracked and untracked sets agree
+    addBitSetElement(&otherSet, 50100);
+    addBitSetElement(&otherSet, 7);
+    isCorrect &= isSubset(&set, &otherSet) && !isSubset(&otherSet, &set);
+    isCorrect &= !isBitSetsEqual(&set, &otherSet);
+
+    BitSet unionSet = getBitSetsUnion(&set, &otherSet);
+    BitSet intersectionSet = getBitSetsIntersection(&set, &otherSet);
+    BitSet complementSet = getBitSetComplement(&set);
+
+    isCorrect &= getBitSetCount(&unionSet) == 2 &&
+                 isBitSetContains(&unionSet, 7);
+    isCorrect &= isBitSetsEqual(&intersectionSet, &set);
+    isCorrect &= getBitSetCount(&complementSet) == N &&
+                 !isBitSetContains(&complementSet, 50100);
+
+    // The complement keeps tracking its bounds like the source
+    isCorrect &= complementSet.activeRange != NULL;
+    removeBitSetRange(&complementSet, 0, 50100);
+    isCorrect &= findFirstBitSetElement(&complementSet, &element) ==
+                     NONE_ERROR &&
+                 element == 50101;
+
+    enableBitSetSummary(&set);
+    BitSet summaryComplementSet = getBitSetComplement(&set);
+    isCorrect &= summaryComplementSet.summary != NULL &&
+                 getBitSetSummaryWord(&summaryComplementSet, 0) == ~0ULL;
+    destroyBitSet(&summaryComplementSet);
+    disableBitSetSummary(&set);
+    isCorrect &= findFirstBitSetElement(&unionSet, &element) == NONE_ERROR &&
+                 element == 7;
+
+    removeBitSetElement(&otherSet, 7);
+    isCorrect &= isBitSetsEqual(&set, &otherSet);
+
+    removeBitSetElement(&set, 50100);
+    isCorrect &= isBitSetEmpty(&set);
+    isCorrect &= findLastBitSetElement(&set, &element) ==
+                 ELEMENT_NOT_FOUND_ERROR;
+
+    // An empty tracked operand adds no blocks to the combined bounds
+    BitSet symmetricDiffSet = getSymmetricBitSetsDiff(&set, &otherSet);
+    isCorrect &= isBitSetsEqual(&symmetricDiffSet, &otherSet);
+    isCorrect &= !isBitSetsEqual(&set, &otherSet);
+    destroyBitSet(&symmetricDiffSet);
+
+    assertWithMessage(isCorrect, getTestErrorMessage(ACTIVE_RANGE_TEST_ERROR));
+
+    destroyBitSet(&set);
+    destroyBitSet(&otherSet);
+    destroyBitSet(&unionSet);
+    destroyBitSet(&intersectionSet);
+    destroyBitSet(&complementSet);
+}
+
+void testSharedBitSet() {
+    const size_t N = 10000;
+    char name[64];
+    snprintf(name, sizeof(name), "/bitset-test-%ld", (long)getpid());
+
+    SharedBitSet sharedSet;
+    BitSet snapshot;
+    uint64_t generation = 0;
+
+    bool isCorrect = createSharedBitSet(name, N, &sharedSet) == NONE_ERROR;
+    isCorrect &= addSharedBitSetElement(&sharedSet, 42) == NONE_ERROR;
+    isCorrect &= addSharedBitSetElement(&sharedSet, N + 1) ==
+                 CAPACITY_EXCEEDING_ERROR;
+
+    // Another process attaches by name and updates the same blocks
+    const pid_t child = fork();
+    if (child == 0) {
+        SharedBitSet childSet;
+        bool isChildCorrect =
+            attachSharedBitSet(name, &childSet) == NONE_ERROR &&
+            isSharedBitSetContains(&childSet, 42);
+        for (uint64_t element = 1000; element < 2000 && isChildCorrect;
+             element++) {
+            isChildCorrect = addSharedBitSetElement(&childSet, element) ==
+                             NONE_ERROR;
+        }
+        removeSharedBitSetElement(&childSet, 42);
+        detachSharedBitSet(&childSet);
+        _exit(isChildCorrect ? 0 : 1);
+    }
+
+    int childStatus = 1;
+    isCorrect &= child > 0 && waitpid(child, &childStatus, 0) == child;
+    isCorrect &= WIFEXITED(childStatus) && WEXITSTATUS(childStatus) == 0;
+
+    isCorrect &= !isSharedBitSetContains(&sharedSet, 42);
+    isCorrect &= isSharedBitSetContains(&sharedSet, 1999);
+    isCorrect &= getSharedBitSetGeneration(&sharedSet) == 1002;
+
+    isCorrect &= getSharedBitSetSnapshot(&sharedSet, &snapshot,
+                                         &generation) == NONE_ERROR;
+    isCorrect &= generation == 1002 && getBitSetCount(&snapshot) == 1000;
+    isCorrect &= isBitSetsEqual(&snapshot, &sharedSet.bitSet);
+    destroyBitSet(&snapshot);
+
+    // A writer adds 2000, 2001, ... in order, so a consistent snapshot of
+    // generation g holds exactly g - 1002 of them
+    const pid_t writer = fork();
+    if (writer == 0) {
+        SharedBitSet writerSet;
+        bool isWriterCorrect = attachSharedBitSet(name, &writerSet) == NONE_ERROR;
+        for (uint64_t element = 2000; element < N && isWriterCorrect;
+             element++) {
+            isWriterCorrect = addSharedBitSetElement(&writerSet, element) ==
+                              NONE_ERROR;
+        }
+        detachSharedBitSet(&writerSet);
+        _exit(isWriterCorrect ? 0 : 1);
+    }
+
+    int writerStatus = 1;
+    bool isWriterRunning = writer > 0;
+    while (isWriterRunning) {
+        const BaseErrorCode statusCode =
+            getSharedBitSetSnapshot(&sharedSet, &snapshot, &generation);
+        const size_t written = (size_t)(generation - 1002);
+
+        isCorrect &= statusCode == NONE_ERROR ||
+                     statusCode == SHARED_SNAPSHOT_ERROR;
+        if (statusCode == NONE_ERROR) {
+            isCorrect &= getBitSetCount(&snapshot) == 1000 + written;
+            isCorrect &= written == 0 ||
+                         isBitSetContains(&snapshot, 2000 + written - 1);
+            isCorrect &= !isBitSetContains(&snapshot, 2000 + written);
+        }
+        destroyBitSet(&snapshot);
+
+        isWriterRunning = waitpid(writer, &writerStatus, WNOHANG) == 0;
+    }
+    isCorrect &= WIFEXITED(writerStatus) && WEXITSTATUS(writerStatus) == 0;
+
+    // A writer which died in the middle of an update blocks snapshots
+    // until the set is repaired
+    __atomic_fetch_add(&sharedSet.header->startedUpdates, 1, __ATOMIC_SEQ_CST);
+    isCorrect &= getSharedBitSetSnapshot(&sharedSet, &snapshot,
+                                         &generation) == SHARED_SNAPSHOT_ERROR;
+    destroyBitSet(&snapshot);
+    repairSharedBitSet(&sharedSet);
+    isCorrect &= getSharedBitSetSnapshot(&sharedSet, &snapshot,
+                                         &generation) == NONE_ERROR;
+    isCorrect &= getBitSetCount(&snapshot) == 1000 + (N - 2000);
+
+    // The name is taken until it is removed
+    SharedBitSet secondSet;
+    isCorrect &= createSharedBitSet(name, N, &secondSet) == SHARED_MEMORY_ERROR;
+
+    detachSharedBitSet(&sharedSet);
+    isCorrect &= removeSharedBitSet(name) == NONE_ERROR;
+    isCorrect &= attachSharedBitSet(name, &sharedSet) == SHARED_MEMORY_ERROR;
+
+    assertWithMessage(isCorrect, getTestErrorMessage(SHARED_BITSET_TEST_ERROR));
+
+    destroyBitSet(&snapshot);
+}
+
+/*
+  Checks that the iterator yields exactly the elements of the set
+*/
+bool isIteratorMatches(BitSetIterator *iterator, const BitSet *expectedSet) {
+    bool isMatches = true;
+    uint64_t element = 0;
+    size_t count = 0;
+
+    while (nextBitSetIteratorElement(iterator, &element)) {
+        isMatches &= isBitSetContains(expectedSet, element);
+        count++;
+    }
+
+    return isMatches && count == getBitSetCount(expectedSet);
+}
+
+void testIterator() {
+    const size_t N = 5000;
+
+    BitSet set1 = createBitSet(N);
+    BitSet set2 = createBitSet(N / 2);
+    bool isCorrect = true;
+
+    for (uint64_t element = 0; element <= N; element += 3) {
+        addBitSetElement(&set1, element);
+    }
+    for (uint64_t element = 0; element <= N / 2; element += 5) {
+        addBitSetElement(&set2, element);
+    }
+    enableBitSetSummary(&set1);
+
+    BitSet unionSet = getBitSetsUnion(&set1, &set2);
+    BitSet intersectionSet = getBitSetsIntersection(&set1, &set2);
+    BitSet diffSet = getBitSetsDiff(&set1, &set2);
+    BitSet symmetricDiffSet = getSymmetricBitSetsDiff(&set2, &set1);
+
+    BitSetIterator iterator = createBitSetIterator(&set1);
+    isCorrect &= isIteratorMatches(&iterator, &set1);
+    iterator = createBitSetsUnionIterator(&set1, &set2);
+    isCorrect &= isIteratorMatches(&iterator, &unionSet);
+    iterator = createBitSetsIntersectionIterator(&set1, &set2);
+    isCorrect &= isIteratorMatches(&iterator, &intersectionSet);
+    iterator = createBitSetsDiffIterator(&set1, &set2);
+    isCorrect &= isIteratorMatches(&iterator, &diffSet);
+    iterator = createSymmetricBitSetsDiffIterator(&set2, &set1);
+    isCorrect &= isIteratorMatches(&iterator, &symmetricDiffSet);
+
+    // Multiples of 15 from the 100th one on, at most 4 of them
+    uint64_t elements[8];
+    iterator = createBitSetsIntersectionIterator(&set1, &set2);
+    limitBitSetIterator(&iterator, 100, 4);
+    isCorrect &= nextBitSetIteratorElements(&iterator, 8, elements) == 4;
+    isCorrect &= elements[0] == 1500 && elements[3] == 1545;
+
+    // An offset past the end leaves nothing
+    iterator = createBitSetIterator(&set2);
+    limitBitSetIterator(&iterator, N, 10);
+    isCorrect &= !nextBitSetIteratorElement(&iterator, &elements[0]);
+
+    // Tracked sets start from the summary word of their first block
+    BitSet trackedSet1 = createBitSet(N * 20);
+    BitSet trackedSet2 = createBitSet(N * 20);
+    enableBitSetActiveRange(&trackedSet1);
+    enableBitSetActiveRange(&trackedSet2);
+    addBitSetElement(&trackedSet1, 70000);
+    addBitSetElement(&trackedSet1, 90000);
+    addBitSetElement(&trackedSet2, 50000);
+    addBitSetElement(&trackedSet2, 90000);
+
+    BitSet trackedUnionSet = getBitSetsUnion(&trackedSet1, &trackedSet2);
+    iterator = createBitSetsUnionIterator(&trackedSet1, &trackedSet2);
+    isCorrect &= iterator.wordPos == 50000 / BIT_PER_BLOCK / BIT_PER_BLOCK;
+    isCorrect &= isIteratorMatches(&iterator, &trackedUnionSet);
+
+    iterator = createBitSetsIntersectionIterator(&trackedSet1, &trackedSet2);
+    isCorrect &= iterator.wordPos == 70000 / BIT_PER_BLOCK / BIT_PER_BLOCK;
+    isCorrect &= nextBitSetIteratorElements(&iterator, 8, elements) == 1 &&
+                 elements[0] == 90000;
+
+    // A set without a range still scans from the start
+    iterator = createBitSetsDiffIterator(&set1, &trackedSet1);
+    isCorrect &= iterator.wordPos == 0 && isIteratorMatches(&iterator, &set1);
+
+    removeBitSetElement(&trackedSet2, 50000);
+    removeBitSetElement(&trackedSet2, 90000);
+    iterator = createBitSetIterator(&trackedSet2);
+    isCorrect &= !nextBitSetIteratorElement(&iterator, &elements[0]);
+
+    assertWithMessage(isCorrect, getTestErrorMessage(ITERATOR_TEST_ERROR));
+
+    destroyBitSet(&trackedSet1);
+    destroyBitSet(&trackedSet2);
+    destroyBitSet(&trackedUnionSet);
+
+    destroyBitSet(&set1);
+    destroyBitSet(&set2);
+    destroyBitSet(&unionSet);
+    destroyBitSet(&intersectionSet);
+    destroyBitSet(&diffSet);
+    destroyBitSet(&symmetricDiffSet);
+}
+
+void testArrayOperations() {
+    const size_t N = 10000;
+
+    BitSet set = createBitSet(N);
+    bool isCorrect = true;
+
+    for (uint64_t element = 0; element <= N; element += 2) {
+        addBitSetElement(&set, element);
+    }
+
+    {
+        uint64_t elements[] = {7, 4, N + 2, 9998, 3, 0, 64, N + 1, 128};
+        const size_t kept = filterBitSetElements(&set, 9, elements);
+
+        isCorrect &= kept == 5;
+        isCorrect &= elements[0] == 4 && elements[1] == 9998 &&
+                     elements[2] == 0 && elements[3] == 64 &&
+                     elements[4] == 128;
+    }
+
+    {
+        const uint64_t unsorted[] = {10, 4};
+        isCorrect &= intersectBitSetWithSortedElements(&set, 2, unsorted) ==
+                     INVALID_ARGUMENT_ERROR;
+        isCorrect &= getBitSetCount(&set) == N / 2 + 1;
+
+        const uint64_t sorted[] = {1, 2, 3, 130, 131, 132, 5000, 5001, N + 5};
+        isCorrect &= intersectBitSetWithSortedElements(&set, 9, sorted) ==
+                     NONE_ERROR;
+        isCorrect &= getBitSetCount(&set) == 4;
+        isCorrect &= isBitSetContains(&set, 2) && isBitSetContains(&set, 130) &&
+                     isBitSetContains(&set, 132) && isBitSetContains(&set, 5000);
+    }
+
+    {
+        const uint64_t unsorted[] = {5, 1000, 3};
+        isCorrect &= mergeSortedElementsIntoBitSet(&set, 3, unsorted) ==
+                     INVALID_ARGUMENT_ERROR;
+        isCorrect &= getBitSetCount(&set) == 4;
+
+        const uint64_t sorted[] = {0, 63, 64, 5000, 9000, N, N + 1};
+        isCorrect &= mergeSortedElementsIntoBitSet(&set, 7, sorted) ==
+                     CAPACITY_EXCEEDING_ERROR;
+        isCorrect &= getBitSetCount(&set) == 9;
+        isCorrect &= isBitSetContains(&set, 63) && isBitSetContains(&set, N);
+    }
+
+    assertWithMessage(isCorrect,
+                      getTestErrorMessage(ARRAY_OPERATION_TEST_ERROR));
+
+    destroyBitSet(&set);
+}
+
 int main() {
     testBoundary();
     testAdd();
@@ -498,6 +1720,23 @@ int main() {
     testIntersection();
     testDiff();
     testSymmetricDiff();
+    testSummary();
+    testFind();
+    testAllocate();
+    testIngest();
+    testHash();
+    testIntern();
+    testDelta();
+    testFixedBitSet();
+    testWindow();
+    testShift();
+    testBloomFilter();
+    testJournal();
+    testBulkBuild();
+    testActiveRange();
+    testSharedBitSet();
+    testIterator();
+    testArrayOperations();
 
     printf("All tests passed!\n");
 